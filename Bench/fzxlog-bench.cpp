@@ -0,0 +1,338 @@
+// fzxlog-bench: latency and throughput of the loggers, sinks and patterns.
+//
+//   fzxlog-bench [-t max_threads] [-n calls_per_thread] [-d work_dir] [-o out.json]
+//
+// Every logger/sink/pattern combination (JsonFormatter counts as a pattern) runs with 1, 2, 4, ... max_threads producers.
+// Each call is timed on its own for the latency percentiles; throughput counts every
+// call up to the end of flush(), so async loggers are measured at sustained rate.
+// Also measured: the mean cost of a call filtered out by the logger level (mean_ps),
+// and latency while RotationFileSink rotates every few hundred records.
+// Log files go to a fzxlog-bench-<pid> directory created under work_dir and removed at
+// the end; nothing else under work_dir is touched.
+// Results are written as JSON (stdout by default).
+
+#include "FZXLog/FZXLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#define FZXLOG_BENCH_GETPID _getpid
+#else
+#include <unistd.h>
+#define FZXLOG_BENCH_GETPID getpid
+#endif
+
+using namespace FZXLog;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    size_t m_max_threads = std::max<size_t>(1, std::min<size_t>(8, std::thread::hardware_concurrency()));
+    size_t m_calls = 100000;
+    std::string m_dir = ".";
+    std::string m_out;
+};
+
+struct Result {
+    std::string m_name;
+    std::string m_logger;
+    std::string m_sink;
+    std::string m_pattern;
+    size_t m_threads = 0;
+    size_t m_calls = 0;
+    double m_seconds = 0;
+    uint64_t m_p50 = 0;
+    uint64_t m_p99 = 0;
+    uint64_t m_p999 = 0;
+    uint64_t m_max = 0;
+    uint64_t m_mean_ps = 0; // Filtered calls only
+    bool m_sampled = true;  // Percentiles measured per call, filtered calls only have the mean
+};
+
+// Formats every record and throws the text away: measures the formatter alone
+class NullSink : public Sink::Sink {
+private:
+    std::string m_buffer;
+    std::mutex m_mutex;
+
+protected:
+    void write(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffer.clear();
+        if (m_formatter) m_formatter->format_to(m_buffer, p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+    }
+
+public:
+    explicit NullSink(std::shared_ptr<Fmt::Formatter> p_formatter) : Sink(std::move(p_formatter), Level::Trace, Level::Off) {}
+    void flush() noexcept override {}
+};
+
+std::shared_ptr<Logger::Logger> makeLogger(const std::string& p_name, Level p_level) {
+    if (p_name == "sync") return std::make_shared<Logger::SyncLogger>(p_level, Level::Off, 0);
+    if (p_name == "concurrent") return std::make_shared<Logger::ConcurrentLogger>(p_level, Level::Off);
+    if (p_name == "async") return std::make_shared<Logger::AsyncLogger>(p_level, Level::Off, 0);
+    if (p_name == "pool") {
+        // Scheduling overhead of the shared backend against a thread of the logger's own
+        return std::make_shared<Logger::AsyncLogger>(p_level, Level::Off, 0, 8192, Logger::OverflowPolicy::Block, std::make_shared<Logger::BackendPool>(1));
+    }
+    return std::make_shared<Logger::PerThreadAsyncLogger>(p_level, Level::Off, 0);
+}
+
+std::shared_ptr<Sink::Sink> makeSink(const std::string& p_name, const std::string& p_pattern, const std::string& p_dir, size_t p_max_file_size) {
+    // "json" selects JsonFormatter
+    std::shared_ptr<Fmt::Formatter> formatter;
+    if (p_pattern == "json") formatter = std::make_shared<Fmt::JsonFormatter>();
+    else formatter = std::make_shared<Fmt::PatternFormatter>(p_pattern);
+    if (p_name == "null") return std::make_shared<NullSink>(formatter);
+    if (p_name == "rotation") {
+        return std::make_shared<Sink::RotationFileSink>(p_dir + "/rotation.log", formatter, Level::Trace, Level::Off, p_max_file_size);
+    }
+#if !defined(_WIN32)
+    if (p_name == "mmap") return std::make_shared<Sink::MmapFileSink>(p_dir + "/mmap.log", formatter, Level::Trace, Level::Off);
+#endif
+#if defined(__linux__)
+    if (p_name == "uring") return std::make_shared<Sink::UringFileSink>(p_dir + "/uring.log", formatter, Level::Trace, Level::Off, p_max_file_size);
+#endif
+    return std::make_shared<Sink::BinaryFileSink>(p_dir + "/binary.bin", Level::Trace, Level::Off);
+}
+
+uint64_t percentile(std::vector<uint32_t>& p_samples, double p_rank) {
+    if (p_samples.empty()) return 0;
+    const size_t index = std::min(p_samples.size() - 1, static_cast<size_t>(p_rank * static_cast<double>(p_samples.size())));
+    std::nth_element(p_samples.begin(), p_samples.begin() + static_cast<std::ptrdiff_t>(index), p_samples.end());
+    return p_samples[index];
+}
+
+// Runs p_calls logging calls on each of p_threads threads.
+// With p_per_call, every call is timed; otherwise only the total is.
+Result run(
+    const std::shared_ptr<Logger::Logger>& p_logger,
+    Level p_level,
+    size_t p_threads,
+    size_t p_calls,
+    bool p_per_call
+) {
+    std::vector<std::vector<uint32_t>> samples(p_threads);
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < p_threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<uint32_t>& own = samples[t];
+            own.resize(p_per_call ? p_calls : 1);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            const auto loopStart = Clock::now();
+            for (size_t i = 0; i < p_calls; ++i) {
+                const auto start = p_per_call ? Clock::now() : Clock::time_point();
+                FZXLOG_LOG(p_logger, p_level, "benchmark record {} from worker {} value {:.3f}", i, t, 3.14159);
+                if (p_per_call) {
+                    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                    own[i] = static_cast<uint32_t>(std::min<int64_t>(ns, UINT32_MAX));
+                }
+            }
+            if (!p_per_call) {
+                // Mean per call in picoseconds, filtered calls are too cheap for whole nanoseconds
+                const auto ps = std::chrono::duration_cast<std::chrono::duration<int64_t, std::pico>>(Clock::now() - loopStart).count();
+                own[0] = static_cast<uint32_t>(std::min<int64_t>(ps / static_cast<int64_t>(p_calls), UINT32_MAX));
+            }
+        });
+    }
+
+    while (ready.load() != p_threads) std::this_thread::yield();
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads) thread.join();
+    p_logger->flush();
+    const auto end = Clock::now();
+
+    Result result;
+    result.m_threads = p_threads;
+    result.m_calls = p_threads * p_calls;
+    result.m_seconds = std::chrono::duration<double>(end - start).count();
+
+    if (p_per_call) {
+        std::vector<uint32_t> all;
+        all.reserve(result.m_calls);
+        for (const auto& own : samples) all.insert(all.end(), own.begin(), own.end());
+        result.m_max = all.empty() ? 0 : *std::max_element(all.begin(), all.end());
+        result.m_p50 = percentile(all, 0.50);
+        result.m_p99 = percentile(all, 0.99);
+        result.m_p999 = percentile(all, 0.999);
+    } else {
+        // Mean cost per call over the threads, too short to time one by one
+        uint64_t sum = 0;
+        for (const auto& own : samples) sum += own[0];
+        result.m_mean_ps = sum / p_threads;
+        result.m_sampled = false;
+    }
+    return result;
+}
+
+std::string jsonEscape(const std::string& p_text) {
+    std::string out;
+    for (char c : p_text) {
+        if (c == '"' || c == '\\') out.push_back('\\');
+        out.push_back(c);
+    }
+    return out;
+}
+
+void writeJson(std::FILE* p_out, const Options& p_options, const std::vector<Result>& p_results) {
+    std::fprintf(p_out, "{\n  \"library\": \"FZXLog\",\n  \"timestamp\": %lld,\n  \"hardware_threads\": %u,\n  \"calls_per_thread\": %zu,\n  \"results\": [\n",
+        static_cast<long long>(std::time(nullptr)), std::thread::hardware_concurrency(), p_options.m_calls);
+
+    for (size_t i = 0; i < p_results.size(); ++i) {
+        const Result& r = p_results[i];
+        std::fprintf(p_out,
+            "    {\"name\": \"%s\", \"logger\": \"%s\", \"sink\": \"%s\", \"pattern\": \"%s\", \"threads\": %zu, \"calls\": %zu, "
+            "\"seconds\": %.6f, \"throughput_per_sec\": %.0f, \"mean_ps\": %llu",
+            jsonEscape(r.m_name).c_str(), r.m_logger.c_str(), r.m_sink.c_str(), jsonEscape(r.m_pattern).c_str(), r.m_threads, r.m_calls,
+            r.m_seconds, r.m_seconds > 0 ? static_cast<double>(r.m_calls) / r.m_seconds : 0.0,
+            static_cast<unsigned long long>(r.m_mean_ps));
+        // Filtered runs have no percentiles, only the mean
+        if (r.m_sampled) {
+            std::fprintf(p_out, ", \"latency_ns\": {\"p50\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}",
+                static_cast<unsigned long long>(r.m_p50), static_cast<unsigned long long>(r.m_p99),
+                static_cast<unsigned long long>(r.m_p999), static_cast<unsigned long long>(r.m_max));
+        }
+        std::fprintf(p_out, "}%s\n", i + 1 < p_results.size() ? "," : "");
+    }
+    std::fprintf(p_out, "  ]\n}\n");
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: fzxlog-bench [-t max_threads] [-n calls_per_thread] [-d work_dir] [-o out.json]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "-t") == 0 && hasValue) {
+            options.m_max_threads = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "-n") == 0 && hasValue) {
+            options.m_calls = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "-d") == 0 && hasValue) {
+            options.m_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "-o") == 0 && hasValue) {
+            options.m_out = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    const std::vector<std::string> loggers = {"sync", "concurrent", "async", "pool", "perthread"};
+    std::vector<std::string> sinks = {"null", "rotation", "binary"};
+#if !defined(_WIN32)
+    sinks.push_back("mmap");
+#endif
+#if defined(__linux__)
+    sinks.push_back("uring");
+#endif
+    const std::vector<std::string> patterns = {FZXLOG_FMT_PATTERN_BASIC, FZXLOG_FMT_PATTERN_FULL, "json"};
+
+    std::vector<size_t> threadCounts;
+    for (size_t n = 1; n < options.m_max_threads; n *= 2) threadCounts.push_back(n);
+    threadCounts.push_back(options.m_max_threads);
+
+    // Private to this run, it is the only directory the benchmark ever removes
+    const std::filesystem::path workDir = std::filesystem::path(options.m_dir) / ("fzxlog-bench-" + std::to_string(FZXLOG_BENCH_GETPID()));
+    std::error_code ec;
+    if (std::filesystem::exists(workDir, ec) || !std::filesystem::create_directories(workDir, ec)) {
+        std::fprintf(stderr, "fzxlog-bench: cannot create a fresh %s\n", workDir.string().c_str());
+        return 1;
+    }
+    const std::string workPath = workDir.string();
+
+    std::vector<Result> results;
+
+    auto scenario = [&](const std::string& p_name, const std::string& p_logger, const std::string& p_sink,
+                        const std::string& p_pattern, size_t p_threads, Level p_loggerLevel, Level p_callLevel,
+                        bool p_per_call, size_t p_max_file_size) {
+        std::filesystem::remove_all(workDir, ec);
+        std::filesystem::create_directories(workDir, ec);
+
+        Result result;
+        {
+            auto logger = makeLogger(p_logger, p_loggerLevel);
+            logger->addSink(makeSink(p_sink, p_pattern, workPath, p_max_file_size));
+            // Filtered calls are cheap, give them more iterations
+            result = run(logger, p_callLevel, p_threads, p_per_call ? options.m_calls : options.m_calls * 10, p_per_call);
+        }
+        result.m_name = p_name;
+        result.m_logger = p_logger;
+        result.m_sink = p_sink;
+        result.m_pattern = p_pattern;
+        results.push_back(result);
+        if (result.m_sampled) {
+            std::fprintf(stderr, "%-10s %-10s %-8s %-3zu threads  %12.0f/s  p50 %6llu ns  p99.9 %8llu ns\n",
+                p_name.c_str(), p_logger.c_str(), p_sink.c_str(), p_threads,
+                static_cast<double>(result.m_calls) / result.m_seconds,
+                static_cast<unsigned long long>(result.m_p50), static_cast<unsigned long long>(result.m_p999));
+        } else {
+            std::fprintf(stderr, "%-10s %-10s %-8s %-3zu threads  %12.0f/s  mean %.3f ns\n",
+                p_name.c_str(), p_logger.c_str(), p_sink.c_str(), p_threads,
+                static_cast<double>(result.m_calls) / result.m_seconds,
+                static_cast<double>(result.m_mean_ps) / 1000.0);
+        }
+    };
+
+    const size_t noRotation = static_cast<size_t>(1) << 40;
+
+    for (const auto& logger : loggers) {
+        for (const auto& sink : sinks) {
+            for (const auto& pattern : patterns) {
+                // The binary sink ignores the pattern
+                if (sink == "binary" && pattern != patterns.front()) continue;
+                for (size_t threads : threadCounts) {
+                    scenario("log", logger, sink, sink == "binary" ? "" : pattern, threads, Level::Trace, Level::Info, true, noRotation);
+                }
+            }
+        }
+    }
+
+    for (const auto& logger : loggers) {
+        for (size_t threads : threadCounts) {
+            scenario("filtered", logger, "null", patterns.front(), threads, Level::Error, Level::Debug, false, noRotation);
+        }
+        // Rotation every few hundred records
+        scenario("rotation", logger, "rotation", patterns[1], 1, Level::Trace, Level::Info, true, 64 * 1024);
+    }
+
+    std::filesystem::remove_all(workDir, ec);
+
+    std::FILE* out = options.m_out.empty() ? stdout : std::fopen(options.m_out.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "fzxlog-bench: cannot write %s\n", options.m_out.c_str());
+        return 1;
+    }
+    writeJson(out, options, results);
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "CallSite.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace FZXLog {
+
+const CallSite& CallSite::intern(const char* p_file, uint32_t p_line, const char* p_func) noexcept {
+    using Key = std::tuple<const char*, uint32_t, const char*>;
+    const Key key(p_file, p_line, p_func);
+
+    // Hand-built locations tend to repeat, the last one is remembered per thread
+    thread_local Key t_last_key(nullptr, 0, nullptr);
+    thread_local const CallSite* t_last_site = nullptr;
+    if (t_last_site && t_last_key == key) return *t_last_site;
+
+    static std::mutex s_mutex;
+    static std::map<Key, std::unique_ptr<CallSite>> s_sites;
+    try {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto& site = s_sites[key];
+        if (!site) site = std::make_unique<CallSite>(fileBasename(p_file ? p_file : ""), p_line, p_func ? p_func : "");
+        t_last_key = key;
+        t_last_site = site.get();
+        return *site;
+    } catch (...) {
+        return s_unknown_call_site;
+    }
+}
+
+std::atomic<CallSite*>& CallSiteRegistry::head() noexcept {
+    static constinit std::atomic<CallSite*> s_head{nullptr};
+    return s_head;
+}
+
+void CallSiteRegistry::add(CallSite& p_site) noexcept {
+    if (p_site.m_registered.exchange(true, std::memory_order_acq_rel)) return;
+
+    std::atomic<CallSite*>& list = head();
+    CallSite* next = list.load(std::memory_order_relaxed);
+    do {
+        p_site.m_next = next;
+    } while (!list.compare_exchange_weak(next, &p_site, std::memory_order_release, std::memory_order_relaxed));
+}
+
+std::vector<CallSite*> CallSiteRegistry::list() {
+    std::vector<CallSite*> sites;
+    forEach([&](CallSite& p_site) { sites.push_back(&p_site); });
+    return sites;
+}
+
+size_t CallSiteRegistry::setEnabled(std::string_view p_file, uint32_t p_line, bool p_enabled) noexcept {
+    const size_t separator = p_file.find_last_of("/\\");
+    const std::string_view wanted = separator == std::string_view::npos ? p_file : p_file.substr(separator + 1);
+    size_t changed = 0;
+    forEach([&](CallSite& p_site) {
+        if (std::string_view(fileBasename(p_site.m_file)) != wanted) return;
+        if (p_line != 0 && p_site.m_line != p_line) return;
+        p_site.setEnabled(p_enabled);
+        ++changed;
+    });
+    return changed;
+}
+
+} // namespace FZXLog
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+
+#include <string_view>
+#include <vector>
+
+namespace FZXLog {
+
+// Process-wide list of the call sites that have run at least once.
+// Sites are only ever added, so walking the list never takes a lock.
+class CallSiteRegistry {
+private:
+
+    static std::atomic<CallSite*>& head() noexcept;
+    static void add(CallSite& p_site) noexcept;
+
+public:
+
+    // Adds p_site on its first use, a single relaxed load afterwards
+    static void ensureRegistered(CallSite& p_site) noexcept {
+        if (!p_site.m_registered.load(std::memory_order_relaxed)) add(p_site);
+    }
+
+    // Calls p_visitor(CallSite&) for every registered site, newest first
+    template<typename Visitor>
+    static void forEach(Visitor&& p_visitor) {
+        for (CallSite* site = head().load(std::memory_order_acquire); site; site = site->m_next) {
+            p_visitor(*site);
+        }
+    }
+
+    static std::vector<CallSite*> list();
+
+    // Switches the sites of p_file (matched on the basename) at p_line, or at every line
+    // when p_line is 0. Returns the number of sites changed.
+    static size_t setEnabled(std::string_view p_file, uint32_t p_line, bool p_enabled) noexcept;
+};
+
+} // namespace FZXLog
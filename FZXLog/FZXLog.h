@@ -2,13 +2,26 @@
 
 #include "FZXLog/Fmt/Formatter.h"
 #include "FZXLog/Fmt/PatternFormatter.h"
+#include "FZXLog/Fmt/JsonFormatter.h"
 
 #include "FZXLog/Sink/Sink.h"
 #include "FZXLog/Sink/ConsoleSink.h"
 #include "FZXLog/Sink/RotationFileSink.h"
+#include "FZXLog/Sink/MmapFileSink.h"
+#include "FZXLog/Sink/BinaryFileSink.h"
+#include "FZXLog/Sink/UringFileSink.h"
+
+#include "FZXLog/Filter/Filter.h"
+#include "FZXLog/Filter/RateLimitFilter.h"
+#include "FZXLog/Filter/DuplicateFilter.h"
 
 #include "FZXLog/Logger/SyncLogger.h"
+#include "FZXLog/Logger/ConcurrentLogger.h"
 #include "FZXLog/Logger/AsyncLogger.h"
+#include "FZXLog/Logger/PerThreadAsyncLogger.h"
+
+#include "FZXLog/Registry.h"
+#include "FZXLog/Macros.h"
 
 #include <memory>
 
@@ -18,5 +31,9 @@ namespace FZXLog::Sink {
 
 using ConsoleSink = ConsoleSink_mt;
 using RotationFileSink = RotationFileSink_mt;
+using BinaryFileSink = BinaryFileSink_mt;
+#if defined(__linux__)
+using UringFileSink = UringFileSink_mt;
+#endif
 
 } // namespace FZXLog::Sink
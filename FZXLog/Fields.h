@@ -0,0 +1,185 @@
+#pragma once
+
+#include <concepts>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <stdint.h>
+
+namespace FZXLog {
+
+enum class FieldType : uint8_t {
+    Bool   = 0,
+    Int    = 1,
+    UInt   = 2,
+    Double = 3,
+    String = 4
+};
+
+// One typed key/value pair.
+// Passed to a log call it refers to the caller's data; read back from Fields it
+// refers to the Fields buffer.
+struct Field {
+
+    // Public members
+
+    std::string_view m_key;
+    FieldType m_type;
+    union {
+        bool m_bool;
+        int64_t m_int;
+        uint64_t m_uint;
+        double m_double;
+    };
+    std::string_view m_string;
+
+    // Constructor/Destructor
+
+    Field(std::string_view p_key, bool p_value) noexcept :
+        m_key(p_key), m_type(FieldType::Bool), m_bool(p_value) {}
+
+    template<std::signed_integral T>
+    Field(std::string_view p_key, T p_value) noexcept :
+        m_key(p_key), m_type(FieldType::Int), m_int(static_cast<int64_t>(p_value)) {}
+
+    template<std::unsigned_integral T> requires (!std::same_as<T, bool>)
+    Field(std::string_view p_key, T p_value) noexcept :
+        m_key(p_key), m_type(FieldType::UInt), m_uint(static_cast<uint64_t>(p_value)) {}
+
+    template<std::floating_point T>
+    Field(std::string_view p_key, T p_value) noexcept :
+        m_key(p_key), m_type(FieldType::Double), m_double(static_cast<double>(p_value)) {}
+
+    Field(std::string_view p_key, std::string_view p_value) noexcept :
+        m_key(p_key), m_type(FieldType::String), m_uint(0), m_string(p_value) {}
+    Field(std::string_view p_key, const std::string& p_value) noexcept :
+        Field(p_key, std::string_view(p_value)) {}
+    Field(std::string_view p_key, const char* p_value) noexcept :
+        Field(p_key, p_value ? std::string_view(p_value) : std::string_view()) {}
+};
+
+// Key/value fields of one record, encoded back to back in a single buffer:
+// [u8 type][u8 key size][key][value], numbers as 8 raw bytes, strings as [u32 size][bytes].
+// Keys are cut to 255 bytes.
+class Fields {
+private:
+
+    // Private members
+
+    std::string m_data;
+    uint32_t m_count = 0;
+
+    static constexpr size_t encodedSize(const Field& p_field) noexcept {
+        const size_t key = p_field.m_key.size() < 255 ? p_field.m_key.size() : 255;
+        return 2 + key + (p_field.m_type == FieldType::String ? 4 + p_field.m_string.size() : 8);
+    }
+
+    void append(const Field& p_field) {
+        const size_t key = p_field.m_key.size() < 255 ? p_field.m_key.size() : 255;
+        m_data.push_back(static_cast<char>(p_field.m_type));
+        m_data.push_back(static_cast<char>(key));
+        m_data.append(p_field.m_key.data(), key);
+        if (p_field.m_type == FieldType::String) {
+            const uint32_t size = static_cast<uint32_t>(p_field.m_string.size());
+            m_data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            m_data.append(p_field.m_string.data(), size);
+        } else {
+            const uint64_t bits = p_field.m_type == FieldType::Bool ? p_field.m_bool : p_field.m_uint;
+            m_data.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        }
+        ++m_count;
+    }
+
+    // Also passes the buffer offset at which each field ends
+    template<typename Visitor>
+    void forEachUntil(Visitor&& p_visitor) const {
+        const char* data = m_data.data();
+        const size_t size = m_data.size();
+        size_t offset = 0;
+        while (offset + 2 <= size) {
+            const auto type = static_cast<FieldType>(data[offset]);
+            const size_t keySize = static_cast<uint8_t>(data[offset + 1]);
+            offset += 2;
+            if (offset + keySize > size || type > FieldType::String) return;
+
+            Field field(std::string_view(data + offset, keySize), false);
+            field.m_type = type;
+            offset += keySize;
+
+            if (type == FieldType::String) {
+                uint32_t length;
+                if (offset + sizeof(length) > size) return;
+                std::memcpy(&length, data + offset, sizeof(length));
+                offset += sizeof(length);
+                if (length > size - offset) return;
+                field.m_string = std::string_view(data + offset, length);
+                offset += length;
+            } else {
+                if (offset + sizeof(uint64_t) > size) return;
+                std::memcpy(&field.m_uint, data + offset, sizeof(uint64_t));
+                offset += sizeof(uint64_t);
+                if (type == FieldType::Bool) field.m_bool = field.m_uint != 0;
+            }
+            p_visitor(static_cast<const Field&>(field), offset);
+        }
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    Fields() = default;
+
+    // Sizes the buffer once for all fields
+    Fields(std::initializer_list<Field> p_fields) {
+        size_t size = 0;
+        for (const Field& field : p_fields) size += encodedSize(field);
+        m_data.reserve(size);
+        for (const Field& field : p_fields) append(field);
+    }
+
+    // Methods
+
+    void add(const Field& p_field) {
+        append(p_field);
+    }
+
+    void clear() noexcept {
+        m_data.clear();
+        m_count = 0;
+    }
+
+    bool empty() const noexcept {
+        return m_count == 0;
+    }
+    size_t size() const noexcept {
+        return m_count;
+    }
+
+    // Encoded form, as stored by the binary sink
+    const std::string& data() const noexcept {
+        return m_data;
+    }
+
+    // Rebuilds fields from their encoded form, stops at the first malformed field
+    static Fields fromData(std::string_view p_data) {
+        Fields fields;
+        fields.m_data.assign(p_data);
+        size_t valid = 0;
+        fields.forEachUntil([&](const Field&, size_t p_end) {
+            valid = p_end;
+            ++fields.m_count;
+        });
+        fields.m_data.resize(valid);
+        return fields;
+    }
+
+    // Calls p_visitor(const Field&) for each field in insertion order
+    template<typename Visitor>
+    void forEach(Visitor&& p_visitor) const {
+        forEachUntil([&](const Field& p_field, size_t) { p_visitor(p_field); });
+    }
+};
+
+} // namespace FZXLog
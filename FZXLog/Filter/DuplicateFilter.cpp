@@ -0,0 +1,60 @@
+#include "DuplicateFilter.h"
+
+#include <string_view>
+
+namespace FZXLog::Filter {
+
+bool DuplicateFilter::filter(
+    const SourceLocation& p_location,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_thread_id,
+    Emitter& p_emit
+) noexcept {
+    uint64_t hash = static_cast<uint64_t>(std::hash<std::string_view>()(p_message));
+    hash ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p_location.m_site)) * 0x9E3779B97F4A7C15ull;
+    hash ^= static_cast<uint64_t>(p_level) + 1;
+
+    if (m_last_hash.load(std::memory_order_relaxed) == hash ||
+        m_last_hash.exchange(hash, std::memory_order_acq_rel) == hash) {
+        m_repeats.fetch_add(1, std::memory_order_relaxed);
+        m_suppressed_total.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // A new run starts: close the previous one
+    const uint64_t repeats = m_repeats.exchange(0, std::memory_order_acq_rel);
+    if (repeats > 0) {
+        emitSummary(repeats, p_timestamp, p_thread_id, p_emit);
+    }
+    m_last_site.store(p_location.m_site, std::memory_order_relaxed);
+    m_last_level.store(p_level, std::memory_order_relaxed);
+    return true;
+}
+
+void DuplicateFilter::flush(Emitter& p_emit) noexcept {
+    const uint64_t repeats = m_repeats.exchange(0, std::memory_order_acq_rel);
+    if (repeats > 0) {
+        emitSummary(repeats, std::chrono::system_clock::now(), std::this_thread::get_id(), p_emit);
+    }
+}
+
+void DuplicateFilter::emitSummary(
+    uint64_t p_repeats,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_thread_id,
+    Emitter& p_emit
+) noexcept {
+    try {
+        p_emit.emit(
+            SourceLocation(*m_last_site.load(std::memory_order_relaxed)),
+            m_last_level.load(std::memory_order_relaxed),
+            "Previous message repeated " + std::to_string(p_repeats) + " times",
+            p_timestamp,
+            p_thread_id
+        );
+    } catch (...) {}
+}
+
+} // namespace FZXLog::Filter
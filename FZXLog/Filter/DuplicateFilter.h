@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Filter.h"
+
+#include <atomic>
+
+namespace FZXLog::Filter {
+
+// Collapses consecutive identical records (same call site, level and message) into the
+// first one plus a "previous message repeated N times" record, written when a different
+// record arrives or the logger flushes.
+// Records are compared by hash with atomics only; when several threads log at once,
+// "consecutive" is the order in which they reach the filter.
+class DuplicateFilter : public Filter {
+private:
+
+    // Private members
+
+    std::atomic<uint64_t> m_last_hash{0};
+    std::atomic<uint64_t> m_repeats{0};
+    std::atomic<const CallSite*> m_last_site{&s_unknown_call_site};
+    std::atomic<Level> m_last_level{Level::Off};
+    std::atomic<uint64_t> m_suppressed_total{0};
+
+    void emitSummary(
+        uint64_t p_repeats,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        Emitter& p_emit
+    ) noexcept;
+
+public:
+
+    // Constructor/Destructor
+
+    DuplicateFilter() = default;
+    ~DuplicateFilter() override = default;
+
+    // Methods
+
+    bool filter(
+        const SourceLocation& p_location,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        Emitter& p_emit
+    ) noexcept override;
+
+    void flush(Emitter& p_emit) noexcept override;
+
+    // Records dropped so far
+    uint64_t getSuppressed() const noexcept {
+        return m_suppressed_total.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace FZXLog::Filter
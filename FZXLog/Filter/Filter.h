@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace FZXLog::Filter {
+
+// Receives the records a filter adds to the stream, such as repeat summaries.
+// They go straight to the sinks without passing through the filters again.
+class Emitter {
+public:
+    virtual ~Emitter() = default;
+
+    virtual void emit(
+        const SourceLocation& p_location,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id
+    ) noexcept = 0;
+};
+
+// Base Abstract Filter class.
+// Runs between the logger level check and the sinks, possibly from several threads at once.
+class Filter {
+public:
+
+    // Constructor/Destructor
+
+    Filter() = default;
+    virtual ~Filter() = default;
+
+    // Methods
+
+    // Returns false to drop the record. p_emit writes extra records ahead of it.
+    virtual bool filter(
+        const SourceLocation& p_location,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        Emitter& p_emit
+    ) noexcept = 0;
+
+    // Called before the sinks are flushed, writes out anything the filter is holding back
+    virtual void flush(Emitter& p_emit) noexcept {
+        (void)p_emit;
+    }
+};
+
+} // namespace FZXLog::Filter
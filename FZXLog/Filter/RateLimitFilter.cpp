@@ -0,0 +1,75 @@
+#include "RateLimitFilter.h"
+
+#include <algorithm>
+#include <string_view>
+
+namespace FZXLog::Filter {
+
+namespace {
+
+// Final mix of splitmix64, spreads pointer and hash keys over the table
+inline uint64_t mix(uint64_t p_value) noexcept {
+    p_value ^= p_value >> 30;
+    p_value *= 0xBF58476D1CE4E5B9ull;
+    p_value ^= p_value >> 27;
+    p_value *= 0x94D049BB133111EBull;
+    return p_value ^ (p_value >> 31);
+}
+
+} // namespace
+
+RateLimitFilter::RateLimitFilter(double p_rate, double p_burst, RateLimitKey p_key, size_t p_buckets) :
+    m_interval(static_cast<int64_t>(1e9 / std::max(p_rate, 1e-9))),
+    m_tolerance(static_cast<int64_t>(static_cast<double>(m_interval) * std::max(p_burst, 1.0))),
+    m_key(p_key)
+{
+    size_t size = 2;
+    while (size < p_buckets) size <<= 1;
+    m_buckets = std::make_unique<Bucket[]>(size);
+    m_mask = size - 1;
+}
+
+bool RateLimitFilter::filter(
+    const SourceLocation& p_location,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_thread_id,
+    Emitter& p_emit
+) noexcept {
+    const bool bySite = m_key == RateLimitKey::CallSite && p_location.m_site != &s_unknown_call_site;
+    const uint64_t key = mix(bySite
+        ? static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p_location.m_site))
+        : static_cast<uint64_t>(std::hash<std::string_view>()(p_message)));
+
+    // Colliding keys share the bucket and its budget, so a collision can only limit more
+    Bucket& bucket = m_buckets[key & m_mask];
+
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(p_timestamp.time_since_epoch()).count();
+    int64_t tat = bucket.m_tat.load(std::memory_order_relaxed);
+    for (;;) {
+        const int64_t next = std::max(tat, now) + m_interval;
+        if (next - now > m_tolerance) {
+            bucket.m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            m_suppressed_total.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (bucket.m_tat.compare_exchange_weak(tat, next, std::memory_order_relaxed)) break;
+    }
+
+    const uint64_t suppressed = bucket.m_suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed > 0) {
+        try {
+            p_emit.emit(
+                p_location,
+                p_level,
+                "Rate limit: " + std::to_string(suppressed) + " similar records were dropped",
+                p_timestamp,
+                p_thread_id
+            );
+        } catch (...) {}
+    }
+    return true;
+}
+
+} // namespace FZXLog::Filter
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Filter.h"
+
+#include <atomic>
+#include <memory>
+
+namespace FZXLog::Filter {
+
+// What the rate limit is counted against
+enum class RateLimitKey : uint8_t {
+    CallSite = 0,   // Each logging macro call site, records without one fall back to Message
+    Message  = 1    // Each distinct message text
+};
+
+// Token bucket rate limiting per call site or per message.
+// Every key may log p_burst records at once and p_rate records per second after that.
+// The bucket is a single atomic "theoretical arrival time" (GCRA), so a check is one CAS.
+// Keys share a fixed table of buckets; keys landing in the same bucket share its budget.
+// When a key is let through again, a summary of how many records it lost is written first.
+class RateLimitFilter : public Filter {
+private:
+
+    // Private types
+
+    struct Bucket {
+        std::atomic<int64_t> m_tat{0};          // ns, time at which the bucket is full again
+        std::atomic<uint64_t> m_suppressed{0};
+    };
+
+    // Private members
+
+    int64_t m_interval;     // ns per token
+    int64_t m_tolerance;    // ns of burst allowed ahead of now
+    RateLimitKey m_key;
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_mask;
+    std::atomic<uint64_t> m_suppressed_total{0};
+
+public:
+
+    // Constructor/Destructor
+
+    RateLimitFilter(
+        double p_rate = 10.0,
+        double p_burst = 10.0,
+        RateLimitKey p_key = RateLimitKey::CallSite,
+        size_t p_buckets = 1024
+    );
+    ~RateLimitFilter() override = default;
+
+    // Methods
+
+    bool filter(
+        const SourceLocation& p_location,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        Emitter& p_emit
+    ) noexcept override;
+
+    // Records dropped so far
+    uint64_t getSuppressed() const noexcept {
+        return m_suppressed_total.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace FZXLog::Filter
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <stdint.h>
+
+namespace FZXLog::Fmt {
+
+enum class Timezone : uint8_t {
+    Local = 0,
+    UTC   = 1
+};
+
+// Calendar breakdown of one second, with its offset from UTC
+struct CalendarSecond {
+
+    // Public members
+
+    std::time_t m_second = static_cast<std::time_t>(-1);
+    Timezone m_timezone = Timezone::Local;
+    std::tm m_tm{};
+    int32_t m_utc_offset = 0; // seconds east of UTC
+};
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's algorithm)
+constexpr int64_t daysFromCivil(int64_t p_year, uint32_t p_month, uint32_t p_day) noexcept {
+    p_year -= p_month <= 2;
+    const int64_t era = (p_year >= 0 ? p_year : p_year - 399) / 400;
+    const uint32_t yoe = static_cast<uint32_t>(p_year - era * 400);
+    const uint32_t doy = (153 * (p_month + (p_month > 2 ? -3 : 9)) + 2) / 5 + p_day - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+inline bool toCalendar(std::time_t p_time, Timezone p_timezone, std::tm& p_out) noexcept {
+#if defined(_WIN32)
+    return (p_timezone == Timezone::UTC ? gmtime_s(&p_out, &p_time) : localtime_s(&p_out, &p_time)) == 0;
+#else
+    return (p_timezone == Timezone::UTC ? gmtime_r(&p_time, &p_out) : localtime_r(&p_time, &p_out)) != nullptr;
+#endif
+}
+
+// Returns the calendar breakdown of p_time's second.
+// Kept per thread, so the tz conversion only runs when the second changes.
+inline const CalendarSecond& calendarSecond(std::time_t p_time, Timezone p_timezone) noexcept {
+    thread_local CalendarSecond cache;
+
+    if (cache.m_second != p_time || cache.m_timezone != p_timezone) {
+        cache.m_second = p_time;
+        cache.m_timezone = p_timezone;
+        if (!toCalendar(p_time, p_timezone, cache.m_tm)) {
+            cache.m_tm = std::tm{};
+            cache.m_utc_offset = 0;
+            return cache;
+        }
+
+        const std::tm& tm = cache.m_tm;
+        const int64_t asUtc =
+            daysFromCivil(tm.tm_year + 1900, static_cast<uint32_t>(tm.tm_mon + 1), static_cast<uint32_t>(tm.tm_mday)) * 86400 +
+            tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+        cache.m_utc_offset = static_cast<int32_t>(asUtc - static_cast<int64_t>(p_time));
+    }
+    return cache;
+}
+
+} // namespace FZXLog::Fmt
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace FZXLog::Fmt {
+
+// Renders a captured payload with its format string, appending to p_out
+using DeferredDecoder = void (*)(std::string_view p_format, const char* p_payload, std::string& p_out);
+
+// Opt-in for a trivially copyable type whose formatting only reads its own bytes (no
+// pointer or view members), so it can be copied as raw bytes and formatted later:
+//     template<> struct FZXLog::Fmt::DeferredCopy<Point> : std::true_type {};
+template<typename T>
+struct DeferredCopy : std::false_type {};
+
+template<typename Rep, typename Period>
+struct DeferredCopy<std::chrono::duration<Rep, Period>> : std::true_type {};
+template<typename Clock, typename Duration>
+struct DeferredCopy<std::chrono::time_point<Clock, Duration>> : std::true_type {};
+template<> struct DeferredCopy<std::chrono::day> : std::true_type {};
+template<> struct DeferredCopy<std::chrono::month> : std::true_type {};
+template<> struct DeferredCopy<std::chrono::year> : std::true_type {};
+template<> struct DeferredCopy<std::chrono::weekday> : std::true_type {};
+template<> struct DeferredCopy<std::chrono::year_month_day> : std::true_type {};
+
+// Argument capture rules: strings are copied inline; arithmetic, enum and chrono values
+// and DeferredCopy types are copied as raw bytes. Everything else, pointers, ranges and
+// structs that may point at memory the record does not own, is formatted eagerly on the
+// calling thread.
+template<typename T>
+struct DeferredArg {
+    static constexpr bool value =
+        std::is_trivially_copyable_v<T> &&
+        (std::is_arithmetic_v<T> || std::is_enum_v<T> || DeferredCopy<T>::value);
+
+    using Decoded = T;
+
+    static void encode(std::string& p_out, const T& p_value) {
+        p_out.append(reinterpret_cast<const char*>(&p_value), sizeof(T));
+    }
+    // Through bit_cast, so T needs no default constructor
+    static Decoded decode(const char*& p_cursor) noexcept {
+        std::array<char, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), p_cursor, sizeof(T));
+        p_cursor += sizeof(T);
+        return std::bit_cast<T>(bytes);
+    }
+};
+
+struct DeferredStringArg {
+    static constexpr bool value = true;
+
+    using Decoded = std::string_view;
+
+    static void encode(std::string& p_out, std::string_view p_value) {
+        const size_t size = p_value.size();
+        p_out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        p_out.append(p_value.data(), size);
+    }
+    static Decoded decode(const char*& p_cursor) noexcept {
+        size_t size;
+        std::memcpy(&size, p_cursor, sizeof(size));
+        p_cursor += sizeof(size);
+        const std::string_view value(p_cursor, size);
+        p_cursor += size;
+        return value;
+    }
+};
+
+template<> struct DeferredArg<std::string> : DeferredStringArg {};
+template<> struct DeferredArg<std::string_view> : DeferredStringArg {};
+template<> struct DeferredArg<char*> : DeferredStringArg {
+    static void encode(std::string& p_out, const char* p_value) {
+        DeferredStringArg::encode(p_out, p_value ? std::string_view(p_value) : std::string_view());
+    }
+};
+template<> struct DeferredArg<const char*> : DeferredArg<char*> {};
+template<> struct DeferredArg<std::nullptr_t> {
+    static constexpr bool value = true;
+
+    using Decoded = const void*;
+
+    static void encode(std::string& p_out, const void* p_value) {
+        p_out.append(reinterpret_cast<const char*>(&p_value), sizeof(p_value));
+    }
+    static Decoded decode(const char*& p_cursor) noexcept {
+        const void* value;
+        std::memcpy(&value, p_cursor, sizeof(value));
+        p_cursor += sizeof(value);
+        return value;
+    }
+};
+
+template<> struct DeferredArg<const void*> : DeferredArg<std::nullptr_t> {};
+template<> struct DeferredArg<void*> : DeferredArg<std::nullptr_t> {};
+
+template<typename... Args>
+inline constexpr bool isDeferrable = (DeferredArg<std::decay_t<Args>>::value && ...);
+
+// Appends the binary form of p_args to p_out
+template<typename... Args>
+void encodeDeferred(std::string& p_out, const Args&... p_args) {
+    (DeferredArg<std::decay_t<Args>>::encode(p_out, p_args), ...);
+}
+
+// Decoder instantiated at the call site and run on the backend thread
+template<typename... Args>
+void decodeDeferred(std::string_view p_format, const char* p_payload, std::string& p_out) {
+    // Braced initialization keeps the arguments in encoding order
+    std::tuple<typename DeferredArg<std::decay_t<Args>>::Decoded...> values{
+        DeferredArg<std::decay_t<Args>>::decode(p_payload)...
+    };
+    std::apply([&](auto&... p_values) {
+        std::vformat_to(std::back_inserter(p_out), p_format, std::make_format_args(p_values...));
+    }, values);
+}
+
+// Per-thread scratch buffer used while capturing arguments
+inline std::string& deferredScratch() noexcept {
+    thread_local std::string scratch;
+    return scratch;
+}
+
+} // namespace FZXLog::Fmt
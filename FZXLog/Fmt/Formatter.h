@@ -2,6 +2,8 @@
 
 #include "FZXLog/Utils.h"
 
+#include <charconv>
+#include <sstream>
 #include <string>
 #include <chrono>
 #include <thread>
@@ -10,6 +12,39 @@
 
 namespace FZXLog::Fmt {
 
+// Appends p_value zero padded to at least p_width digits
+inline void appendPadded(std::string& p_out, uint32_t p_value, int p_width) {
+    char buffer[16];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), p_value);
+    for (int len = static_cast<int>(end - buffer); len < p_width; ++len) {
+        p_out.push_back('0');
+    }
+    p_out.append(buffer, end);
+}
+
+inline void appendThreadId(std::string& p_out, const std::thread::id& p_thread_id) {
+    // Rendering a thread id goes through iostreams, keep the last one per thread
+    thread_local std::thread::id cached_id;
+    thread_local std::string cached_text;
+
+    if (cached_text.empty() || cached_id != p_thread_id) {
+        std::ostringstream oss;
+        oss << p_thread_id;
+        cached_text = oss.str();
+        cached_id = p_thread_id;
+    }
+    p_out.append(cached_text);
+}
+
+// Appends p_offset seconds as +hh:mm
+inline void appendUtcOffset(std::string& p_out, int32_t p_offset) {
+    p_out.push_back(p_offset < 0 ? '-' : '+');
+    const uint32_t minutes = static_cast<uint32_t>(p_offset < 0 ? -p_offset : p_offset) / 60;
+    appendPadded(p_out, minutes / 60, 2);
+    p_out.push_back(':');
+    appendPadded(p_out, minutes % 60, 2);
+}
+
 // Base Abstract Formatter class
 class Formatter {
 public:
@@ -28,6 +63,23 @@ public:
         const std::thread::id& p_thread_id
     ) const noexcept = 0;
 
+    // Appends the formatted record to p_out, which callers reuse between records.
+    // The default implementation leaves the fields out.
+    virtual void format_to(
+        std::string& p_out,
+        const SourceLocation& p_location,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const Fields& p_fields
+    ) const noexcept {
+        (void)p_fields;
+        try {
+            p_out.append(format(p_location, p_level, p_message, p_timestamp, p_thread_id));
+        } catch (...) {}
+    }
+
 };
 
 } // namespace FZXLog::Fmt
@@ -0,0 +1,266 @@
+#include "JsonFormatter.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FZXLOG_JSON_SSE2 1
+#endif
+
+namespace FZXLog::Fmt {
+
+namespace {
+
+inline bool needsEscape(unsigned char p_c) noexcept {
+    return p_c < 0x20 || p_c == '"' || p_c == '\\';
+}
+
+// First byte of [p_begin, p_end) that needs escaping, p_end if there is none
+inline const char* findEscape(const char* p_begin, const char* p_end) noexcept {
+    const char* it = p_begin;
+
+#if defined(FZXLOG_JSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    const auto scan = [&](const char* p_at) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_at));
+        // Unsigned c <= 0x1F is max(c, 0x1F) == 0x1F
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)
+        );
+        return static_cast<unsigned>(_mm_movemask_epi8(hits));
+    };
+    while (p_end - it >= 16) {
+        const unsigned mask = scan(it);
+        if (mask != 0) return it + std::countr_zero(mask);
+        it += 16;
+    }
+    // The tail is covered by one load ending at p_end, ignoring the bytes already checked
+    if (it != p_end && p_end - p_begin >= 16) {
+        const unsigned checked = static_cast<unsigned>(16 - (p_end - it));
+        const unsigned mask = scan(p_end - 16) >> checked;
+        return mask != 0 ? it + std::countr_zero(mask) : p_end;
+    }
+#else
+    // Eight bytes at a time: skip words without a control byte, quote or backslash
+    constexpr uint64_t ones = 0x0101010101010101ull;
+    constexpr uint64_t highs = 0x8080808080808080ull;
+    const auto hasZero = [](uint64_t p_word) { return (p_word - ones) & ~p_word & highs; };
+    while (p_end - it >= 8) {
+        uint64_t word;
+        std::memcpy(&word, it, sizeof(word));
+        const uint64_t below = (word - ones * 0x20) & ~word & highs;
+        if (below | hasZero(word ^ (ones * '"')) | hasZero(word ^ (ones * '\\'))) break;
+        it += 8;
+    }
+#endif
+
+    while (it < p_end && !needsEscape(static_cast<unsigned char>(*it))) ++it;
+    return it;
+}
+
+inline void appendEscape(std::string& p_out, unsigned char p_c) {
+    switch (p_c) {
+        case '"':  p_out.append("\\\""); break;
+        case '\\': p_out.append("\\\\"); break;
+        case '\n': p_out.append("\\n"); break;
+        case '\r': p_out.append("\\r"); break;
+        case '\t': p_out.append("\\t"); break;
+        case '\b': p_out.append("\\b"); break;
+        case '\f': p_out.append("\\f"); break;
+        default: {
+            static constexpr char hex[] = "0123456789abcdef";
+            const char text[6] = { '\\', 'u', '0', '0', hex[p_c >> 4], hex[p_c & 0xF] };
+            p_out.append(text, sizeof(text));
+            break;
+        }
+    }
+}
+
+inline void appendString(std::string& p_out, std::string_view p_text) {
+    p_out.push_back('"');
+    appendJsonEscaped(p_out, p_text);
+    p_out.push_back('"');
+}
+
+void appendFields(std::string& p_out, const FZXLog::Fields& p_fields) {
+    p_fields.forEach([&](const FZXLog::Field& p_field) {
+        p_out.push_back(',');
+        appendString(p_out, p_field.m_key);
+        p_out.push_back(':');
+
+        char buffer[32];
+        switch (p_field.m_type) {
+            case FZXLog::FieldType::Bool:
+                p_out.append(p_field.m_bool ? "true" : "false");
+                break;
+            case FZXLog::FieldType::Int:
+                p_out.append(buffer, static_cast<size_t>(std::to_chars(buffer, buffer + sizeof(buffer), p_field.m_int).ptr - buffer));
+                break;
+            case FZXLog::FieldType::UInt:
+                p_out.append(buffer, static_cast<size_t>(std::to_chars(buffer, buffer + sizeof(buffer), p_field.m_uint).ptr - buffer));
+                break;
+            case FZXLog::FieldType::Double:
+                // JSON has no NaN or infinity
+                if (std::isfinite(p_field.m_double)) {
+                    p_out.append(buffer, static_cast<size_t>(std::to_chars(buffer, buffer + sizeof(buffer), p_field.m_double).ptr - buffer));
+                } else {
+                    p_out.append("null");
+                }
+                break;
+            case FZXLog::FieldType::String:
+                appendString(p_out, p_field.m_string);
+                break;
+        }
+    });
+}
+
+// "YYYY-MM-DDTHH:MM:SS" of the current second, rendered once per second per thread
+struct JsonTimeCache {
+    std::time_t m_second = static_cast<std::time_t>(-1);
+    Timezone m_timezone = Timezone::UTC;
+    std::string m_text;
+    std::string m_offset;
+};
+
+} // namespace
+
+void appendJsonEscaped(std::string& p_out, std::string_view p_text) {
+    const char* it = p_text.data();
+    const char* end = it + p_text.size();
+    while (it < end) {
+        const char* special = findEscape(it, end);
+        p_out.append(it, static_cast<size_t>(special - it));
+        if (special == end) break;
+        appendEscape(p_out, static_cast<unsigned char>(*special));
+        it = special + 1;
+    }
+}
+
+JsonFormatter::JsonFormatter(const Timezone& p_timezone, bool p_location) noexcept :
+    m_timezone(p_timezone),
+    m_location(p_location)
+{}
+
+std::string JsonFormatter::format(
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_thread_id
+) const noexcept {
+    std::string out;
+    format_to(out, p_location, p_level, p_message, p_timestamp, p_thread_id, FZXLog::Fields());
+    return out;
+}
+
+void JsonFormatter::format_to(
+    std::string& p_out,
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_thread_id,
+    const FZXLog::Fields& p_fields
+) const noexcept {
+    render(p_out, p_location, p_level, p_message, p_timestamp, &p_thread_id, std::string_view(), p_fields);
+}
+
+void JsonFormatter::format_to(
+    std::string& p_out,
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    std::string_view p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    std::string_view p_thread,
+    const FZXLog::Fields& p_fields
+) const noexcept {
+    render(p_out, p_location, p_level, p_message, p_timestamp, nullptr, p_thread, p_fields);
+}
+
+void JsonFormatter::render(
+    std::string& p_out,
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    std::string_view p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id* p_thread_id,
+    std::string_view p_thread,
+    const FZXLog::Fields& p_fields
+) const noexcept {
+    if (p_level == Level::Off) return;
+
+    thread_local JsonTimeCache time;
+
+    const size_t start = p_out.size();
+    try {
+        const size_t needed = p_out.size() + p_message.size() + p_fields.data().size() + 160;
+        if (needed > p_out.capacity()) {
+            p_out.reserve(std::max(needed, p_out.capacity() * 2));
+        }
+
+        const std::time_t second = std::chrono::system_clock::to_time_t(p_timestamp);
+        if (time.m_second != second || time.m_timezone != m_timezone) {
+            const CalendarSecond& calendar = calendarSecond(second, m_timezone);
+            const std::tm& tm = calendar.m_tm;
+            time.m_text.clear();
+            appendPadded(time.m_text, static_cast<uint32_t>(tm.tm_year + 1900), 4);
+            time.m_text.push_back('-');
+            appendPadded(time.m_text, static_cast<uint32_t>(tm.tm_mon + 1), 2);
+            time.m_text.push_back('-');
+            appendPadded(time.m_text, static_cast<uint32_t>(tm.tm_mday), 2);
+            time.m_text.push_back('T');
+            appendPadded(time.m_text, static_cast<uint32_t>(tm.tm_hour), 2);
+            time.m_text.push_back(':');
+            appendPadded(time.m_text, static_cast<uint32_t>(tm.tm_min), 2);
+            time.m_text.push_back(':');
+            appendPadded(time.m_text, static_cast<uint32_t>(tm.tm_sec), 2);
+            time.m_offset.clear();
+            if (m_timezone == Timezone::UTC) time.m_offset.push_back('Z');
+            else appendUtcOffset(time.m_offset, calendar.m_utc_offset);
+            time.m_second = second;
+            time.m_timezone = m_timezone;
+        }
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(p_timestamp.time_since_epoch()) % 1000000;
+
+        p_out.append("{\"time\":\"");
+        p_out.append(time.m_text);
+        p_out.push_back('.');
+        appendPadded(p_out, static_cast<uint32_t>((micros.count() + 1000000) % 1000000), 6);
+        p_out.append(time.m_offset);
+
+        p_out.append("\",\"level\":\"");
+        p_out.append(FZXLogLevelToString(p_level));
+
+        p_out.append("\",\"thread\":\"");
+        if (p_thread_id) appendThreadId(p_out, *p_thread_id);
+        else appendJsonEscaped(p_out, p_thread);
+        p_out.push_back('"');
+
+        if (m_location) {
+            p_out.append(",\"file\":");
+            appendString(p_out, p_location.file() ? p_location.file() : "");
+            p_out.append(",\"line\":");
+            appendPadded(p_out, p_location.line(), 0);
+            p_out.append(",\"function\":");
+            appendString(p_out, p_location.function() ? p_location.function() : "");
+        }
+
+        p_out.append(",\"message\":");
+        appendString(p_out, p_message);
+
+        appendFields(p_out, p_fields);
+        p_out.push_back('}');
+    } catch (...) {
+        // Never leave half an object behind
+        p_out.resize(start);
+    }
+}
+
+} // namespace FZXLog::Fmt
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Formatter.h"
+#include "Calendar.h"
+
+#include <string_view>
+
+namespace FZXLog::Fmt {
+
+// Appends p_text as the inside of a JSON string: quotes, backslashes and control
+// characters are escaped, other bytes (UTF-8 included) are copied as they are.
+// Clean spans are found 16 bytes at a time with SSE2, 8 at a time elsewhere.
+void appendJsonEscaped(std::string& p_out, std::string_view p_text);
+
+// Renders each record as one JSON object:
+// {"time":"2026-01-02T03:04:05.123456Z","level":"Info","thread":"...","file":"main.cpp",
+//  "line":12,"function":"main","message":"...", <fields>}
+// Fields are appended as top-level members after "message" in the order they were given;
+// keys are not checked against the fixed ones.
+class JsonFormatter : public FZXLog::Fmt::Formatter {
+private:
+
+    // Private Members
+
+    Timezone m_timezone;
+    bool m_location;
+
+    // Shared by both format_to overloads, the thread comes from p_thread_id if set, else p_thread
+    void render(
+        std::string& p_out,
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        std::string_view p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id* p_thread_id,
+        std::string_view p_thread,
+        const FZXLog::Fields& p_fields
+    ) const noexcept;
+
+public:
+
+    // Constructor/Destructor
+
+    // p_location adds "file", "line" and "function"
+    explicit JsonFormatter(
+        const Timezone& p_timezone = Timezone::UTC,
+        bool p_location = true
+    ) noexcept;
+    ~JsonFormatter() override = default;
+
+    // Methods
+
+    std::string format(
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id
+    ) const noexcept override;
+
+    void format_to(
+        std::string& p_out,
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const FZXLog::Fields& p_fields
+    ) const noexcept override;
+
+    // Renders a record whose thread is already text, as read back from a binary log
+    void format_to(
+        std::string& p_out,
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        std::string_view p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        std::string_view p_thread,
+        const FZXLog::Fields& p_fields = FZXLog::Fields()
+    ) const noexcept;
+
+    Timezone getTimezone() const noexcept {
+        return m_timezone;
+    }
+    bool getLocation() const noexcept {
+        return m_location;
+    }
+};
+
+} // namespace FZXLog::Fmt
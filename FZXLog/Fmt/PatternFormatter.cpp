@@ -1,35 +1,103 @@
 #include "PatternFormatter.h"
 
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 
 namespace FZXLog::Fmt {
 
-std::string PatternFormatter::format(
-    const SourceLocation& p_location,
-    const FZXLog::Level& p_level,
-    const std::string& p_message,
-    const std::chrono::system_clock::time_point& p_timestamp,
-    const std::thread::id& p_thread_id
-) const noexcept {
-    if (p_level == Level::Off) return "";
+namespace {
+
+// Renders fields as space separated key=value pairs, strings are quoted when needed
+void appendFields(std::string& p_out, const FZXLog::Fields& p_fields) {
+    bool first = true;
+    p_fields.forEach([&](const FZXLog::Field& p_field) {
+        if (!first) p_out.push_back(' ');
+        first = false;
+        p_out.append(p_field.m_key);
+        p_out.push_back('=');
+
+        char buffer[32];
+        switch (p_field.m_type) {
+            case FZXLog::FieldType::Bool:
+                p_out.append(p_field.m_bool ? "true" : "false");
+                break;
+            case FZXLog::FieldType::Int:
+                p_out.append(buffer, static_cast<size_t>(std::to_chars(buffer, buffer + sizeof(buffer), p_field.m_int).ptr - buffer));
+                break;
+            case FZXLog::FieldType::UInt:
+                p_out.append(buffer, static_cast<size_t>(std::to_chars(buffer, buffer + sizeof(buffer), p_field.m_uint).ptr - buffer));
+                break;
+            case FZXLog::FieldType::Double:
+                p_out.append(buffer, static_cast<size_t>(std::to_chars(buffer, buffer + sizeof(buffer), p_field.m_double).ptr - buffer));
+                break;
+            case FZXLog::FieldType::String: {
+                const std::string_view value = p_field.m_string;
+                if (!value.empty() && value.find_first_of(" =\"\\") == std::string_view::npos) {
+                    p_out.append(value);
+                    break;
+                }
+                p_out.push_back('"');
+                for (const char c : value) {
+                    if (c == '"' || c == '\\') p_out.push_back('\\');
+                    p_out.push_back(c);
+                }
+                p_out.push_back('"');
+                break;
+            }
+        }
+    });
+}
+
+std::atomic<uint64_t> s_next_formatter_id{1};
+
+// Rendered DateTime spans of the current second, shared by the formatters used on a thread
+struct DateTimeCacheEntry {
+    uint64_t m_owner = 0;
+    uint32_t m_token = 0;
+    std::time_t m_second = static_cast<std::time_t>(-1);
+    std::string m_text;
+};
 
-    const std::time_t tt = std::chrono::system_clock::to_time_t(p_timestamp);
-    std::tm tm{};
-    localtime_s(&tm, &tt);
+constexpr size_t DATETIME_CACHE_SIZE = 4;
+thread_local DateTimeCacheEntry s_datetime_cache[DATETIME_CACHE_SIZE];
+thread_local size_t s_datetime_cache_next = 0;
 
-    const auto ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            p_timestamp.time_since_epoch()
-        ) % 1000;
+} // namespace
 
-    std::ostringstream out;
-    out.fill('0');
+PatternFormatter::PatternFormatter(const std::string& p_pattern, const Timezone& p_timezone) noexcept :
+    m_pattern(p_pattern),
+    m_timezone(p_timezone),
+    m_id(s_next_formatter_id.fetch_add(1, std::memory_order_relaxed)),
+    m_uses_time(false)
+{
+    compile();
+}
+
+void PatternFormatter::compile() noexcept {
+    m_program.clear();
+    m_date_program.clear();
+    m_literals.clear();
+    m_uses_time = false;
+
+    auto literal = [this](const char* p_data, size_t p_size) {
+        if (!m_program.empty() && m_program.back().m_op == Op::Literal &&
+            m_program.back().m_offset + m_program.back().m_length == m_literals.size()) {
+            m_program.back().m_length += static_cast<uint32_t>(p_size);
+        } else {
+            m_program.push_back({ Op::Literal, static_cast<uint32_t>(m_literals.size()), static_cast<uint32_t>(p_size) });
+        }
+        m_literals.append(p_data, p_size);
+    };
+    auto field = [this](Op p_op) {
+        m_program.push_back({ p_op, 0, 0 });
+        if (p_op >= Op::Year && p_op <= Op::Millis) m_uses_time = true;
+    };
 
     for (size_t i = 0; i < m_pattern.size(); ++i) {
-        char c = m_pattern[i];
+        const char c = m_pattern[i];
         if (c != '%') {
-            out << c;
+            literal(&m_pattern[i], 1);
             continue;
         }
 
@@ -37,66 +105,227 @@ std::string PatternFormatter::format(
             break;
 
         switch (m_pattern[i]) {
-            case '%': out << '%'; break;
+            case '%': literal("%", 1); break;
 
             // date
-            case 'y':
-                out << std::setw(4) << (tm.tm_year + 1900);
-                break;
-            case 'm':
-                out << std::setw(2) << (tm.tm_mon + 1);
-                break;
-            case 'd':
-                out << std::setw(2) << tm.tm_mday;
-                break;
+            case 'y': field(Op::Year); break;
+            case 'm': field(Op::Month); break;
+            case 'd': field(Op::Day); break;
 
             // time
-            case 'H':
-                out << std::setw(2) << tm.tm_hour;
-                break;
-            case 'M':
-                out << std::setw(2) << tm.tm_min;
-                break;
-            case 'S':
-                out << std::setw(2) << tm.tm_sec;
-                break;
-            case 'e':
-                out << std::setw(3) << ms.count();
-                break;
+            case 'H': field(Op::Hour); break;
+            case 'M': field(Op::Minute); break;
+            case 'S': field(Op::Second); break;
+            case 'e': field(Op::Millis); break;
+            case 'z': field(Op::TzOffset); break;
 
             // metadata
-            case 'l':
-                out << FZXLogLevelToString(p_level);
-                break;
+            case 'l': field(Op::Level); break;
+            case 't': field(Op::Thread); break;
+            case 's': field(Op::File); break;
+            case '#': field(Op::Line); break;
+            case '!': field(Op::Function); break;
 
-            case 't':
-                out << p_thread_id;
-                break;
+            // message
+            case 'v': field(Op::Message); break;
+            case 'F': field(Op::Fields); break;
 
-            case 's':
-                out << p_location.m_file;
+            default:
+                literal(&m_pattern[i - 1], 2);
                 break;
+        }
+    }
 
-            case '#':
-                out << p_location.m_line;
-                break;
+    // Fold runs of literals and second-resolution fields into DateTime tokens,
+    // so "[%y-%m-%d %H:%M:%S" is rendered once per second instead of per record
+    const auto secondField = [](const Token& p_token) {
+        return (p_token.m_op >= Op::Year && p_token.m_op <= Op::Second) || p_token.m_op == Op::TzOffset;
+    };
 
-            case '!':
-                out << p_location.m_func;
-                break;
+    std::vector<Token> program;
+    program.reserve(m_program.size());
+    for (size_t i = 0; i < m_program.size();) {
+        size_t end = i;
+        bool hasField = false;
+        while (end < m_program.size() && (m_program[end].m_op == Op::Literal || secondField(m_program[end]))) {
+            hasField |= secondField(m_program[end]);
+            ++end;
+        }
 
-            // message
-            case 'v':
-                out << p_message;
-                break;
+        if (!hasField) {
+            const size_t last = end > i ? end : i + 1;
+            program.insert(program.end(), m_program.begin() + i, m_program.begin() + last);
+            i = last;
+            continue;
+        }
 
-            default:
-                out << '%' << m_pattern[i];
-                break;
+        program.push_back({ Op::DateTime, static_cast<uint32_t>(m_date_program.size()), static_cast<uint32_t>(end - i) });
+        m_date_program.insert(m_date_program.end(), m_program.begin() + i, m_program.begin() + end);
+        i = end;
+    }
+    m_program = std::move(program);
+}
+
+void PatternFormatter::runDateProgram(
+    std::string& p_out,
+    uint32_t p_offset,
+    uint32_t p_length,
+    const CalendarSecond& p_calendar
+) const {
+    const std::tm& tm = p_calendar.m_tm;
+    for (uint32_t i = p_offset; i < p_offset + p_length; ++i) {
+        const Token& token = m_date_program[i];
+        switch (token.m_op) {
+            case Op::Literal:  p_out.append(m_literals, token.m_offset, token.m_length); break;
+            case Op::Year:     appendPadded(p_out, static_cast<uint32_t>(tm.tm_year + 1900), 4); break;
+            case Op::Month:    appendPadded(p_out, static_cast<uint32_t>(tm.tm_mon + 1), 2); break;
+            case Op::Day:      appendPadded(p_out, static_cast<uint32_t>(tm.tm_mday), 2); break;
+            case Op::Hour:     appendPadded(p_out, static_cast<uint32_t>(tm.tm_hour), 2); break;
+            case Op::Minute:   appendPadded(p_out, static_cast<uint32_t>(tm.tm_min), 2); break;
+            case Op::Second:   appendPadded(p_out, static_cast<uint32_t>(tm.tm_sec), 2); break;
+            case Op::TzOffset: appendUtcOffset(p_out, p_calendar.m_utc_offset); break;
+            default: break;
         }
     }
+}
 
-    return out.str();
+void PatternFormatter::appendDateTime(std::string& p_out, const Token& p_token, const CalendarSecond& p_calendar) const {
+    DateTimeCacheEntry* entry = nullptr;
+    for (DateTimeCacheEntry& candidate : s_datetime_cache) {
+        if (candidate.m_owner == m_id && candidate.m_token == p_token.m_offset) {
+            entry = &candidate;
+            break;
+        }
+    }
+
+    if (!entry) {
+        entry = &s_datetime_cache[s_datetime_cache_next];
+        s_datetime_cache_next = (s_datetime_cache_next + 1) % DATETIME_CACHE_SIZE;
+        entry->m_owner = m_id;
+        entry->m_token = p_token.m_offset;
+        entry->m_second = static_cast<std::time_t>(-1);
+    }
+
+    if (entry->m_second != p_calendar.m_second) {
+        entry->m_text.clear();
+        runDateProgram(entry->m_text, p_token.m_offset, p_token.m_length, p_calendar);
+        entry->m_second = p_calendar.m_second;
+    }
+
+    p_out.append(entry->m_text);
+}
+
+std::string PatternFormatter::format(
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_thread_id
+) const noexcept {
+    std::string out;
+    format_to(out, p_location, p_level, p_message, p_timestamp, p_thread_id, FZXLog::Fields());
+    return out;
+}
+
+void PatternFormatter::format_to(
+    std::string& p_out,
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_thread_id,
+    const FZXLog::Fields& p_fields
+) const noexcept {
+    render(p_out, p_location, p_level, p_message, p_timestamp, &p_thread_id, std::string_view(), p_fields);
+}
+
+void PatternFormatter::format_to(
+    std::string& p_out,
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    std::string_view p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    std::string_view p_thread,
+    const FZXLog::Fields& p_fields
+) const noexcept {
+    render(p_out, p_location, p_level, p_message, p_timestamp, nullptr, p_thread, p_fields);
+}
+
+void PatternFormatter::render(
+    std::string& p_out,
+    const SourceLocation& p_location,
+    const FZXLog::Level& p_level,
+    std::string_view p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id* p_thread_id,
+    std::string_view p_thread,
+    const FZXLog::Fields& p_fields
+) const noexcept {
+    if (p_level == Level::Off) return;
+
+    const CalendarSecond* calendar = nullptr;
+    uint32_t ms = 0;
+    if (m_uses_time) {
+        const auto sinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(p_timestamp.time_since_epoch());
+        const std::time_t tt = std::chrono::system_clock::to_time_t(p_timestamp);
+        calendar = &calendarSecond(tt, m_timezone);
+        ms = static_cast<uint32_t>((sinceEpoch % 1000).count());
+    }
+
+    try {
+        const size_t needed = p_out.size() + m_literals.size() + p_message.size() + 64;
+        if (needed > p_out.capacity()) {
+            p_out.reserve(std::max(needed, p_out.capacity() * 2));
+        }
+
+        for (const Token& token : m_program) {
+            switch (token.m_op) {
+                case Op::Literal:
+                    p_out.append(m_literals, token.m_offset, token.m_length);
+                    break;
+
+                // date and time
+                case Op::DateTime:
+                    appendDateTime(p_out, token, *calendar);
+                    break;
+                case Op::Millis:
+                    appendPadded(p_out, ms, 3);
+                    break;
+
+                // metadata
+                case Op::Level:
+                    p_out.append(FZXLogLevelToString(p_level));
+                    break;
+                case Op::Thread:
+                    if (p_thread_id) appendThreadId(p_out, *p_thread_id);
+                    else p_out.append(p_thread);
+                    break;
+                case Op::File:
+                    if (p_location.file()) p_out.append(p_location.file());
+                    break;
+                case Op::Line:
+                    appendPadded(p_out, p_location.line(), 0);
+                    break;
+                case Op::Function:
+                    if (p_location.function()) p_out.append(p_location.function());
+                    break;
+
+                // message
+                case Op::Message:
+                    p_out.append(p_message);
+                    break;
+                case Op::Fields:
+                    appendFields(p_out, p_fields);
+                    break;
+
+                // second-resolution fields only appear inside DateTime tokens
+                default:
+                    break;
+            }
+        }
+    } catch (...) {
+        return;
+    }
 }
 
-} // namespace FZXLog::Fmt
\ No newline at end of file
+} // namespace FZXLog::Fmt
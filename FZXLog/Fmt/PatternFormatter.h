@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Formatter.h"
+#include "Calendar.h"
+
+#include <string_view>
+#include <vector>
 
 // Pattern Types
 
@@ -12,17 +16,71 @@ namespace FZXLog::Fmt {
 
 class PatternFormatter : public FZXLog::Fmt::Formatter {
 private:
+    // Private Types
+
+    enum class Op : uint8_t {
+        Literal,
+        Year,
+        Month,
+        Day,
+        Hour,
+        Minute,
+        Second,
+        Millis,
+        TzOffset,
+        DateTime,
+        Level,
+        Thread,
+        File,
+        Line,
+        Function,
+        Message,
+        Fields
+    };
+
+    struct Token {
+        Op m_op;
+        uint32_t m_offset; // Literal: span in m_literals, DateTime: span in m_date_program
+        uint32_t m_length;
+    };
+
     // Private Members
 
     std::string m_pattern;
+    Timezone m_timezone;
+    uint64_t m_id;
+    std::string m_literals;
+    std::vector<Token> m_program;
+    std::vector<Token> m_date_program;
+    bool m_uses_time;
+
+    // Parses m_pattern into m_program
+    void compile() noexcept;
+
+    // Appends a DateTime token, re-rendered only when the second changes
+    void appendDateTime(std::string& p_out, const Token& p_token, const CalendarSecond& p_calendar) const;
+    void runDateProgram(std::string& p_out, uint32_t p_offset, uint32_t p_length, const CalendarSecond& p_calendar) const;
+
+    // Shared by both format_to overloads, the thread comes from p_thread_id if set, else p_thread
+    void render(
+        std::string& p_out,
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        std::string_view p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id* p_thread_id,
+        std::string_view p_thread,
+        const FZXLog::Fields& p_fields
+    ) const noexcept;
 
 public:
 
     // Constructor/Destructor
 
-    PatternFormatter(const std::string& p_pattern = FZXLOG_FMT_PATTERN_BASIC) noexcept :
-        m_pattern(p_pattern)
-    {}
+    PatternFormatter(
+        const std::string& p_pattern = FZXLOG_FMT_PATTERN_BASIC,
+        const Timezone& p_timezone = Timezone::Local
+    ) noexcept;
     ~PatternFormatter() override = default;
     
     // Methods
@@ -35,6 +93,34 @@ public:
         const std::thread::id& p_thread_id
     ) const noexcept override;
 
+    void format_to(
+        std::string& p_out,
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const FZXLog::Fields& p_fields
+    ) const noexcept override;
+
+    // Renders a record whose thread is already text, as read back from a binary log
+    void format_to(
+        std::string& p_out,
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        std::string_view p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        std::string_view p_thread,
+        const FZXLog::Fields& p_fields = FZXLog::Fields()
+    ) const noexcept;
+
+    const std::string& getPattern() const noexcept {
+        return m_pattern;
+    }
+    Timezone getTimezone() const noexcept {
+        return m_timezone;
+    }
+
 };
 
-} // namespace FZXLog::Fmt
\ No newline at end of file
+} // namespace FZXLog::Fmt
@@ -1,53 +1,216 @@
 #pragma once
 
-// Deprecated, use SyncLogger instead. Async logging is not recommended due to potential message loss on crashes and increased complexity.
+// Records are handed to a background thread through a bounded, preallocated ring.
+// Given a BackendPool, the logger has no thread of its own and the pool drains it.
+// Queued records are lost if the process crashes before they are drained, unless
+// CrashHandler is installed.
 
 #include "SyncLogger.h"
+#include "RingQueue.h"
+#include "QueuedRecord.h"
+#include "BackendPool.h"
 #include "FZXLog/Utils.h"
 
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <memory>
 
 namespace FZXLog::Logger {
 
-class AsyncLogger : public SyncLogger {
+class AsyncLogger : public SyncLogger, private BackendPool::Task {
 private:
-    std::queue<LogRecord> m_queue;
-    std::mutex m_queueMutex;
-    std::condition_variable m_cv;
+    RingQueue<QueuedRecord> m_queue;
     std::thread m_worker;
     std::atomic<bool> m_running{true};
 
+    // Shared backend: m_scheduled is set while the logger is queued in the pool or running
+    // there, m_in_backend while a pool thread is inside runBackend()
+    std::shared_ptr<BackendPool> m_pool;
+    std::atomic<bool> m_scheduled{false};
+    std::atomic<bool> m_in_backend{false};
+    static inline thread_local const AsyncLogger* t_backend = nullptr;
+
+    // Worker wake-up, only signalled when the worker is actually sleeping
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    std::atomic<bool> m_sleeping{false};
+
+    // flush() callers waiting for the worker, only signalled when there are some
+    std::mutex m_flushedMutex;
+    std::condition_variable m_flushedCv;
+    std::atomic<size_t> m_flush_waiters{0};
+
+    // Records taken out of the queue (written or overwritten)
+    std::atomic<size_t> m_processed{0};
+
+    // Deepest queue seen by the worker
+    std::atomic<size_t> m_high_water{0};
+    // Queue drops at the last resetStats(), the queue counters themselves never reset
+    std::atomic<uint64_t> m_dropped_base{0};
+
+    // Set while the worker takes records out or flushes, a crash waits for it to clear
+    std::atomic<bool> m_draining{false};
+
+    void wakeWorker() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_pool) {
+            if (m_scheduled.load(std::memory_order_relaxed) || m_scheduled.exchange(true, std::memory_order_acq_rel)) return;
+            try {
+                m_pool->schedule(*this);
+            } catch (...) {
+                m_scheduled.store(false, std::memory_order_release);
+            }
+            return;
+        }
+        if (m_sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(m_wakeMutex);
+            m_wakeCv.notify_one();
+        }
+    }
+
+    // Drains up to p_max records, returns how many were written
+    // Called by the worker after a batch
+    void notifyFlushWaiters() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_flush_waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard lock(m_flushedMutex);
+            m_flushedCv.notify_all();
+        }
+    }
+    // Blocks until p_done() holds, woken by notifyFlushWaiters()
+    template<typename Done>
+    void waitFlushed(Done&& p_done) {
+        m_flush_waiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(m_flushedMutex);
+            m_flushedCv.wait(lock, p_done);
+        }
+        m_flush_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    size_t drain(size_t p_max) {
+        const size_t depth = m_queue.size();
+        if (depth > m_high_water.load(std::memory_order_relaxed)) {
+            m_high_water.store(depth, std::memory_order_relaxed);
+        }
+
+        m_draining.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        size_t count = 0;
+        {
+            std::lock_guard<std::recursive_mutex> lk(m_mutex);
+            while (count < p_max && !CrashHandler::isCrashing() && m_queue.tryPop([this](QueuedRecord& p_slot) {
+                p_slot.materialize();
+                const LogRecord& record = p_slot.m_record;
+                dispatch(record.m_location, record.m_level, record.m_message, record.m_timestamp, record.m_threadId, record.m_fields);
+            })) {
+                m_processed.fetch_add(1, std::memory_order_release);
+                ++count;
+            }
+        }
+        // One flush for all the triggers of the batch
+        if (!CrashHandler::isCrashing()) m_flusher.flushIfDue();
+        m_draining.store(false, std::memory_order_release);
+        if (count > 0) notifyFlushWaiters();
+        return count;
+    }
+
     // Worker thread loop
     void workerLoop() {
-        while (m_running || !m_queue.empty()) {
-            LogRecord record{
-                SourceLocation(),
-                Level::Off,
-                std::string(),
-                std::chrono::system_clock::now(),
-                std::thread::id()
-            };
-            {
-                std::unique_lock lock(m_queueMutex);
-                m_cv.wait(lock, [&]() { return !m_queue.empty() || !m_running; });
-
-                if (m_queue.empty()) {
-                    continue;
-                }
+        for (;;) {
+            if (drain(256) > 0)
+                continue;
 
-                record = std::move(m_queue.front());
-                m_queue.pop();
+            if (!m_running.load(std::memory_order_acquire)) {
+                if (m_queue.empty()) break;
+                continue;
             }
 
-            // Write to sinks using base SyncLogger implementation
-            SyncLogger::log(record.m_location, record.m_level, record.m_message);
+            std::unique_lock lock(m_wakeMutex);
+            m_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_queue.empty() && m_running.load(std::memory_order_acquire)) {
+                m_wakeCv.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            m_sleeping.store(false, std::memory_order_relaxed);
         }
         // final flush
-        SyncLogger::flush();
+        m_flusher.flush();
+    }
+
+    // One batch on a pool thread. The logger stays scheduled while records remain; a
+    // record queued just as it lets go finds it unscheduled and schedules it again.
+    bool runBackend() override {
+        m_in_backend.store(true, std::memory_order_relaxed);
+        t_backend = this;
+        drain(256);
+        t_backend = nullptr;
+
+        bool more = !m_queue.empty();
+        if (!more && !CrashHandler::isCrashing()) {
+            m_scheduled.store(false, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            more = !m_queue.empty() && !m_scheduled.exchange(true, std::memory_order_acq_rel);
+        }
+        // A crash leaves the logger scheduled, so it is not run again
+        if (CrashHandler::isCrashing()) more = false;
+        m_in_backend.store(false, std::memory_order_release);
+        return more;
+    }
+
+    bool onBackendThread() const noexcept {
+        return m_pool ? t_backend == this : std::this_thread::get_id() == m_worker.get_id();
+    }
+
+protected:
+
+    void haltOnCrash() noexcept override {
+        if (!onBackendThread()) CrashHandler::waitWhile(m_draining);
+    }
+
+    // Records being filled by a producer when the crash hit end the drain
+    void drainOnCrash(CrashWriter& p_writer) noexcept override {
+        for (size_t i = 0; i < m_queue.capacity(); ++i) {
+            const bool popped = m_queue.tryPop([&](QueuedRecord& p_slot) {
+                const LogRecord& record = p_slot.m_record;
+                const std::string_view line = p_writer.render(record, p_slot.m_decoder ? p_slot.m_format : std::string_view(record.m_message));
+                for (const auto& sink : m_sinks) {
+                    if (sink) p_writer.send(*sink, record.m_level, line);
+                }
+            });
+            if (!popped) break;
+        }
+    }
+
+    // Stores the captured arguments in the slot, the worker formats them
+    void logDeferred(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        std::string_view p_format,
+        Fmt::DeferredDecoder p_decoder,
+        const std::string& p_payload,
+        const Fields& p_fields
+    ) override {
+        if (CrashHandler::isCrashing())
+            return;
+
+        const auto timestamp = std::chrono::system_clock::now();
+        const auto threadId = std::this_thread::get_id();
+
+        const bool queued = m_queue.push(
+            [&](QueuedRecord& p_slot) {
+                p_slot.setDeferred(p_loc, p_level, p_format, p_decoder, p_payload, timestamp, threadId, p_fields);
+            },
+            [this](QueuedRecord&) {
+                m_processed.fetch_add(1, std::memory_order_release);
+            }
+        );
+
+        if (queued) wakeWorker();
     }
 
 public:
@@ -55,44 +218,114 @@ public:
     AsyncLogger& operator=(const AsyncLogger&) = delete;
     AsyncLogger(AsyncLogger&&) = delete;
     AsyncLogger& operator=(AsyncLogger&&) = delete;
-    AsyncLogger(const Level& p_level = Level::Trace, const Level& p_flushLevel = Level::Error, const size_t& p_log_trace_capacity = 100)
-        : SyncLogger(p_level, p_flushLevel, p_log_trace_capacity)
+    // With p_pool the records are written by the pool's threads instead of a thread of
+    // the logger's own
+    AsyncLogger(
+        const Level& p_level = Level::Trace,
+        const Level& p_flushLevel = Level::Error,
+        const size_t& p_log_trace_capacity = 100,
+        const size_t& p_queue_capacity = 8192,
+        const OverflowPolicy& p_overflow_policy = OverflowPolicy::Block,
+        std::shared_ptr<BackendPool> p_pool = nullptr
+    ) :
+        SyncLogger(p_level, p_flushLevel, p_log_trace_capacity),
+        m_queue(p_queue_capacity, p_overflow_policy),
+        m_pool(std::move(p_pool))
     {
-        m_worker = std::thread(&AsyncLogger::workerLoop, this);
+        if (!m_pool) m_worker = std::thread(&AsyncLogger::workerLoop, this);
     }
     ~AsyncLogger() {
-        m_running = false;
-        m_cv.notify_all();
+        CrashHandler::untrack(this);
+        m_flusher.stop();
+
+        if (m_pool) {
+            // Take the logger back from the pool, then write what is left on this thread
+            bool expected = false;
+            while (!m_scheduled.compare_exchange_weak(expected, true, std::memory_order_acq_rel)) {
+                expected = false;
+                std::this_thread::yield();
+            }
+            while (m_in_backend.load(std::memory_order_acquire)) std::this_thread::yield();
+            while (drain(256) > 0) {}
+            m_flusher.flush();
+            return;
+        }
+
+        m_running.store(false, std::memory_order_release);
+        {
+            std::lock_guard lock(m_wakeMutex);
+            m_wakeCv.notify_all();
+        }
         if (m_worker.joinable())
             m_worker.join();
     }
 
     // Log a message
-    void log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message) override {
-        if (p_level == Level::Off || static_cast<uint8_t>(p_level) < static_cast<uint8_t>(getLevel()))
+    void log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message, const Fields& p_fields = Fields()) override {
+        if (!shouldLog(p_level) || CrashHandler::isCrashing())
             return;
 
-        LogRecord record{
-            p_loc,
-            p_level,
-            p_message,
-            std::chrono::system_clock::now(),
-            std::this_thread::get_id()
-        };
+        const auto timestamp = std::chrono::system_clock::now();
+        const auto threadId = std::this_thread::get_id();
 
-        {
-            std::lock_guard lock(m_queueMutex);
-            m_queue.push(std::move(record));
-        }
-        m_cv.notify_one();
+        const bool queued = m_queue.push(
+            [&](QueuedRecord& p_slot) {
+                p_slot.set(p_loc, p_level, p_message, timestamp, threadId, p_fields);
+            },
+            [this](QueuedRecord&) {
+                m_processed.fetch_add(1, std::memory_order_release);
+            }
+        );
+
+        if (queued) wakeWorker();
     }
     void log(const Level& p_level, const std::string& p_message) override { log(SourceLocation(), p_level, p_message); }
 
+    // Waits until every record queued before the call has been written, then flushes the sinks
     void flush() override {
-        std::unique_lock lock(m_queueMutex);
-        m_cv.wait(lock, [&]() { return m_queue.empty(); });
+        if (!onBackendThread()) {
+            const size_t target = m_queue.enqueuePosition();
+            if (m_processed.load(std::memory_order_acquire) < target) {
+                wakeWorker();
+                waitFlushed([&] { return m_processed.load(std::memory_order_acquire) >= target; });
+            }
+        }
         SyncLogger::flush();
     }
+
+    LoggerStats getStats() const override {
+        LoggerStats stats = SyncLogger::getStats();
+        const QueueCounters counters = m_queue.getCounters();
+        stats.m_dropped = counters.m_dropped + counters.m_overwritten - m_dropped_base.load(std::memory_order_relaxed);
+        stats.m_queue_depth = m_queue.size();
+        stats.m_queue_high_water = m_high_water.load(std::memory_order_relaxed);
+        return stats;
+    }
+    void resetStats() override {
+        SyncLogger::resetStats();
+        m_high_water.store(0, std::memory_order_relaxed);
+        const QueueCounters counters = m_queue.getCounters();
+        m_dropped_base.store(counters.m_dropped + counters.m_overwritten, std::memory_order_relaxed);
+    }
+
+    // Queue state
+
+    QueueCounters getQueueCounters() const noexcept {
+        return m_queue.getCounters();
+    }
+    size_t getQueueSize() const noexcept {
+        return m_queue.size();
+    }
+    size_t getQueueCapacity() const noexcept {
+        return m_queue.capacity();
+    }
+    OverflowPolicy getOverflowPolicy() const noexcept {
+        return m_queue.getPolicy();
+    }
+    // The shared backend, null when the logger has its own thread
+    const std::shared_ptr<BackendPool>& getBackendPool() const noexcept {
+        return m_pool;
+    }
 };
 
-} // namespace FZXLog::Logger
\ No newline at end of file
+} // namespace FZXLog::Logger
@@ -0,0 +1,113 @@
+#include "BackendPool.h"
+
+namespace FZXLog::Logger {
+
+namespace {
+
+// Index of the pool thread running the caller, for the pool it belongs to
+thread_local const BackendPool* t_pool = nullptr;
+thread_local size_t t_worker = 0;
+
+} // namespace
+
+BackendPool::BackendPool(size_t p_threads) {
+    const size_t count = p_threads > 0 ? p_threads : 1;
+    m_workers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < count; ++i) {
+        m_workers[i]->m_thread = std::thread(&BackendPool::workerLoop, this, i);
+    }
+}
+
+BackendPool::~BackendPool() {
+    m_running.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_wake_cv.notify_all();
+    }
+    for (auto& worker : m_workers) {
+        if (!worker->m_thread.joinable()) continue;
+        if (worker->m_thread.get_id() == std::this_thread::get_id()) {
+            // The last owner let go from inside a task on this pool thread: it cannot join
+            // itself, so it is detached and leaves its loop once the task returns
+            t_pool = nullptr;
+            worker->m_thread.detach();
+        } else {
+            worker->m_thread.join();
+        }
+    }
+}
+
+void BackendPool::push(size_t p_worker, Task* p_task) {
+    // Counted first, so m_pending never drops below the tasks actually queued
+    m_pending.fetch_add(1, std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> lock(m_workers[p_worker]->m_mutex);
+    m_workers[p_worker]->m_tasks.push_back(p_task);
+}
+
+BackendPool::Task* BackendPool::pop(size_t p_worker) noexcept {
+    Worker& worker = *m_workers[p_worker];
+    std::lock_guard<std::mutex> lock(worker.m_mutex);
+    if (worker.m_tasks.empty()) return nullptr;
+    Task* task = worker.m_tasks.front();
+    worker.m_tasks.pop_front();
+    m_pending.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+BackendPool::Task* BackendPool::steal(size_t p_worker) noexcept {
+    for (size_t i = 1; i < m_workers.size(); ++i) {
+        if (Task* task = pop((p_worker + i) % m_workers.size())) {
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void BackendPool::schedule(Task& p_task) {
+    // Work scheduled by a pool thread stays on it, the rest is spread round robin
+    const size_t worker = t_pool == this ? t_worker : m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    push(worker, &p_task);
+
+    if (m_idle.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_wake_cv.notify_one();
+    }
+}
+
+void BackendPool::workerLoop(size_t p_worker) {
+    t_pool = this;
+    t_worker = p_worker;
+
+    for (;;) {
+        Task* task = pop(p_worker);
+        if (!task) task = steal(p_worker);
+
+        if (task) {
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            bool more = false;
+            try {
+                more = task->runBackend();
+            } catch (...) {}
+            if (t_pool != this) return; // The pool was destroyed by the task
+            if (more) push(p_worker, task);
+            continue;
+        }
+
+        if (!m_running.load(std::memory_order_acquire)) break;
+
+        // schedule() pushes before it checks m_idle and notifies under m_wake_mutex, so a
+        // task queued after the check below still wakes this thread
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_idle.fetch_add(1, std::memory_order_seq_cst);
+        m_wake_cv.wait(lock, [this] {
+            return m_pending.load(std::memory_order_seq_cst) != 0 || !m_running.load(std::memory_order_acquire);
+        });
+        m_idle.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace FZXLog::Logger
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FZXLog::Logger {
+
+// Small set of threads shared by the async loggers given to it, instead of one thread per
+// logger. A logger with queued records is scheduled once and runs one batch at a time, so
+// a logger is never drained by two threads at once and its records keep their order.
+// After a batch a logger that still has records goes to the back of the thread's run
+// queue, behind the other loggers waiting there. Idle threads steal waiting loggers from
+// the other threads' queues, so a hot logger does not hold up the rest.
+// Loggers keep the pool alive through their shared_ptr, it stops once the last one is gone.
+// Idle threads sleep until work is scheduled. If the last owner lets go on a pool thread,
+// that thread is detached instead of joined and exits when its task returns.
+class BackendPool {
+public:
+
+    // A logger as seen by the pool
+    class Task {
+    public:
+        virtual ~Task() = default;
+
+        // Runs one batch, true if the task has more work and stays scheduled
+        virtual bool runBackend() = 0;
+    };
+
+private:
+
+    // Private types
+
+    struct alignas(64) Worker {
+        std::mutex m_mutex;
+        std::deque<Task*> m_tasks;
+        std::thread m_thread;
+    };
+
+    // Private members
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_next{0};      // Round robin for tasks scheduled from outside the pool
+    std::atomic<size_t> m_pending{0};   // Tasks waiting in the run queues
+
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake_cv;
+    std::atomic<size_t> m_idle{0};
+    std::atomic<bool> m_running{true};
+
+    std::atomic<uint64_t> m_batches{0};
+    std::atomic<uint64_t> m_steals{0};
+
+    void push(size_t p_worker, Task* p_task);
+    Task* pop(size_t p_worker) noexcept;
+    Task* steal(size_t p_worker) noexcept;
+    void workerLoop(size_t p_worker);
+
+public:
+
+    // Constructor/Destructor
+
+    explicit BackendPool(size_t p_threads = 1);
+    ~BackendPool();
+
+    BackendPool(const BackendPool&) = delete;
+    BackendPool& operator=(const BackendPool&) = delete;
+
+    // Methods
+
+    // Queues p_task for a run. The caller guarantees it is not already queued or running.
+    void schedule(Task& p_task);
+
+    size_t getThreadCount() const noexcept {
+        return m_workers.size();
+    }
+    // Batches run, and how many of them were taken from another thread's queue
+    uint64_t getBatchCount() const noexcept {
+        return m_batches.load(std::memory_order_relaxed);
+    }
+    uint64_t getStealCount() const noexcept {
+        return m_steals.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace FZXLog::Logger
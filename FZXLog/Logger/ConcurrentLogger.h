@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Logger.h"
+#include "FZXLog/Utils.h"
+#include "FZXLog/Sink/Sink.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace FZXLog::Logger {
+
+// Logger without a logger-wide lock on the logging path.
+// Levels are atomics and the sink set is an immutable array published with an
+// epoch scheme: log() only touches per-thread reader counters, addSink/removeSink
+// copy the array, swap it in and wait for older readers before freeing it.
+// Each sink keeps its own synchronization, so use the _mt sink variants.
+// Sink management must not be called from inside a sink.
+class ConcurrentLogger : public Logger {
+private:
+
+    // Private types
+
+    using SinkArray = std::vector<std::shared_ptr<Sink::Sink>>;
+
+    static constexpr size_t READER_SHARDS = 16;
+
+    struct alignas(64) ReaderShard {
+        std::atomic<uint64_t> m_count{0};
+    };
+
+    // Private members
+
+    std::atomic<const SinkArray*> m_snapshot;
+    std::atomic<uint64_t> m_epoch{0};
+    ReaderShard m_readers[2][READER_SHARDS];
+    mutable std::mutex m_writeMutex;
+
+    static size_t readerShard() noexcept {
+        static std::atomic<size_t> s_next{0};
+        thread_local size_t shard = s_next.fetch_add(1, std::memory_order_relaxed) % READER_SHARDS;
+        return shard;
+    }
+
+    // Pins the current snapshot for the duration of a read
+    class ReadGuard {
+    private:
+        std::atomic<uint64_t>& m_counter;
+        const SinkArray* m_sinks;
+
+    public:
+        explicit ReadGuard(ConcurrentLogger& p_logger) noexcept :
+            m_counter(p_logger.m_readers[p_logger.m_epoch.load() & 1][readerShard()].m_count)
+        {
+            m_counter.fetch_add(1);
+            m_sinks = p_logger.m_snapshot.load();
+        }
+        ~ReadGuard() {
+            m_counter.fetch_sub(1, std::memory_order_release);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const SinkArray& sinks() const noexcept {
+            return *m_sinks;
+        }
+    };
+
+    // Waits until every reader that may still see the previous snapshot is done
+    void synchronize() noexcept {
+        for (int phase = 0; phase < 2; ++phase) {
+            const uint64_t previous = m_epoch.fetch_add(1) & 1;
+            for (;;) {
+                uint64_t active = 0;
+                for (const ReaderShard& shard : m_readers[previous]) {
+                    active += shard.m_count.load();
+                }
+                if (active == 0) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Publishes p_sinks and frees the replaced array once no reader holds it
+    void publish(SinkArray* p_sinks) {
+        const SinkArray* previous = m_snapshot.exchange(p_sinks);
+        synchronize();
+        delete previous;
+    }
+
+protected:
+
+    bool writeToSinks(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) override {
+        ReadGuard guard(*this);
+        Sink::RenderCache::Scope cache;
+        bool flush = false;
+        for (const auto& sink : guard.sinks()) {
+            flush |= sink->append(cache.get(), p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+        }
+        return flush;
+    }
+
+    void flushSinks() override {
+        flushFilters();
+        ReadGuard guard(*this);
+        for (const auto& sink : guard.sinks()) {
+            sink->timedFlush();
+        }
+    }
+
+    void collectSinksOnCrash(CrashWriter& p_writer) noexcept override {
+        ReadGuard guard(*this);
+        for (const auto& sink : guard.sinks()) {
+            p_writer.addSink(sink.get());
+        }
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    ConcurrentLogger(
+        const Level& p_level = Level::Trace,
+        const Level& p_flushLevel = Level::Error,
+        const size_t& p_log_trace_capacity = 0
+    ) :
+        Logger(p_level, p_flushLevel, p_log_trace_capacity),
+        m_snapshot(new SinkArray())
+    {}
+    ~ConcurrentLogger() override {
+        CrashHandler::untrack(this);
+        m_flusher.stop();
+        delete m_snapshot.load();
+    }
+
+    ConcurrentLogger(const ConcurrentLogger&) = delete;
+    ConcurrentLogger& operator=(const ConcurrentLogger&) = delete;
+
+    // Sink management
+
+    void addSink(std::shared_ptr<FZXLog::Sink::Sink> p_sink) override {
+        if (!p_sink) return;
+        std::lock_guard<std::mutex> lk(m_writeMutex);
+        const SinkArray* current = m_snapshot.load();
+        for (const auto& sink : *current) {
+            if (sink == p_sink) return;
+        }
+        auto* next = new SinkArray(*current);
+        next->push_back(std::move(p_sink));
+        publish(next);
+    }
+    void removeSink(std::shared_ptr<FZXLog::Sink::Sink> p_sink) override {
+        std::lock_guard<std::mutex> lk(m_writeMutex);
+        auto* next = new SinkArray();
+        for (const auto& sink : *m_snapshot.load()) {
+            if (sink != p_sink) next->push_back(sink);
+        }
+        publish(next);
+    }
+    void clearSinks() override {
+        std::lock_guard<std::mutex> lk(m_writeMutex);
+        publish(new SinkArray());
+    }
+    std::vector<std::shared_ptr<FZXLog::Sink::Sink>> getSinks() const override {
+        std::lock_guard<std::mutex> lk(m_writeMutex);
+        return *m_snapshot.load();
+    }
+
+    // Flush sinks, concurrent calls share one flush
+    void flush() override {
+        m_flusher.flush();
+    }
+};
+
+} // namespace FZXLog::Logger
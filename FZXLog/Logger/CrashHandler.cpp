@@ -0,0 +1,356 @@
+#include "CrashHandler.h"
+#include "Logger.h"
+
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <mutex>
+
+#if !defined(_WIN32)
+#include <ctime>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace FZXLog::Logger {
+
+// CrashWriter
+
+CrashWriter::Entry* CrashWriter::find(Sink::Sink* p_sink) noexcept {
+    for (size_t i = 0; i < m_sink_count; ++i) {
+        if (m_sinks[i].m_sink == p_sink) return &m_sinks[i];
+    }
+    if (m_sink_count == MAX_SINKS) return nullptr;
+    m_sinks[m_sink_count] = Entry{p_sink, false};
+    return &m_sinks[m_sink_count++];
+}
+
+void CrashWriter::append(std::string_view p_text) noexcept {
+    const size_t size = p_text.size() < LINE_SIZE - m_size ? p_text.size() : LINE_SIZE - m_size;
+    for (size_t i = 0; i < size; ++i) {
+        m_line[m_size + i] = p_text[i];
+    }
+    m_size += size;
+}
+
+void CrashWriter::appendNumber(uint64_t p_value, int p_width) noexcept {
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + p_value % 10);
+        p_value /= 10;
+    } while (p_value > 0 && count < 20);
+    while (count < p_width && count < 20) digits[count++] = '0';
+    while (count > 0 && m_size < LINE_SIZE) m_line[m_size++] = digits[--count];
+}
+
+void CrashWriter::appendTimestamp(const std::chrono::system_clock::time_point& p_timestamp) noexcept {
+    const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(p_timestamp.time_since_epoch()).count();
+    int64_t seconds = us / 1000000;
+    int64_t micros = us % 1000000;
+    if (micros < 0) {
+        micros += 1000000;
+        --seconds;
+    }
+    int64_t days = seconds / 86400;
+    int64_t rest = seconds % 86400;
+    if (rest < 0) {
+        rest += 86400;
+        --days;
+    }
+
+    // Inverse of Fmt::daysFromCivil
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int64_t dayOfEra = days - era * 146097;
+    const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int64_t mp = (5 * dayOfYear + 2) / 153;
+    const int64_t day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t year = yearOfEra + era * 400 + (month <= 2);
+
+    appendNumber(static_cast<uint64_t>(year > 0 ? year : 0), 4);
+    append("-");
+    appendNumber(static_cast<uint64_t>(month), 2);
+    append("-");
+    appendNumber(static_cast<uint64_t>(day), 2);
+    append(" ");
+    appendNumber(static_cast<uint64_t>(rest / 3600), 2);
+    append(":");
+    appendNumber(static_cast<uint64_t>(rest / 60 % 60), 2);
+    append(":");
+    appendNumber(static_cast<uint64_t>(rest % 60), 2);
+    append(".");
+    appendNumber(static_cast<uint64_t>(micros), 6);
+}
+
+std::string_view CrashWriter::render(const LogRecord& p_record, std::string_view p_message) noexcept {
+    m_size = 0;
+    appendTimestamp(p_record.m_timestamp);
+    append(" [");
+    append(FZXLogLevelToString(p_record.m_level));
+    append("] ");
+    if (p_record.m_location.m_site != &s_unknown_call_site) {
+        append(fileBasename(p_record.m_location.file()));
+        append(":");
+        appendNumber(p_record.m_location.line());
+        append(" ");
+    }
+    append(p_message);
+
+    p_record.m_fields.forEach([this](const Field& p_field) {
+        append(" ");
+        append(p_field.m_key);
+        append("=");
+        char number[32];
+        std::to_chars_result result{number, std::errc()};
+        switch (p_field.m_type) {
+            case FieldType::Bool:   append(p_field.m_bool ? "true" : "false"); return;
+            case FieldType::String: append(p_field.m_string); return;
+            case FieldType::Int:    result = std::to_chars(number, number + sizeof(number), p_field.m_int); break;
+            case FieldType::UInt:   result = std::to_chars(number, number + sizeof(number), p_field.m_uint); break;
+            case FieldType::Double: result = std::to_chars(number, number + sizeof(number), p_field.m_double); break;
+        }
+        if (result.ec == std::errc()) append(std::string_view(number, static_cast<size_t>(result.ptr - number)));
+    });
+    return std::string_view(m_line, m_size);
+}
+
+std::string_view CrashWriter::renderSignal(int p_signal, const void* p_address, long p_thread) noexcept {
+    const char* name = "signal";
+    bool fault = false;
+#if !defined(_WIN32)
+    switch (p_signal) {
+        case SIGSEGV: name = "SIGSEGV"; fault = true; break;
+        case SIGABRT: name = "SIGABRT"; break;
+        case SIGBUS:  name = "SIGBUS"; fault = true; break;
+        case SIGFPE:  name = "SIGFPE"; fault = true; break;
+        default: break;
+    }
+#endif
+
+    m_size = 0;
+    appendTimestamp(std::chrono::system_clock::now());
+    append(" [Fatal] Fatal signal ");
+    appendNumber(static_cast<uint64_t>(p_signal));
+    append(" (");
+    append(name);
+    append(")");
+    if (fault) {
+        char hex[2 * sizeof(uintptr_t)];
+        const auto result = std::to_chars(hex, hex + sizeof(hex), reinterpret_cast<uintptr_t>(p_address), 16);
+        append(" at address 0x");
+        append(std::string_view(hex, static_cast<size_t>(result.ptr - hex)));
+    }
+    append(" in thread ");
+    appendNumber(static_cast<uint64_t>(p_thread));
+    return std::string_view(m_line, m_size);
+}
+
+void CrashWriter::addSink(Sink::Sink* p_sink) noexcept {
+    if (p_sink) find(p_sink);
+}
+
+void CrashWriter::send(Sink::Sink& p_sink, const Level& p_level, std::string_view p_line) noexcept {
+    if (static_cast<uint8_t>(p_level) < static_cast<uint8_t>(p_sink.getMinLevel())) return;
+
+    // Bytes the sink buffered before the crash go out ahead of the drained records
+    Entry* entry = find(&p_sink);
+    if (entry && !entry->m_spilled) {
+        entry->m_spilled = true;
+        p_sink.spillEmergency();
+    }
+    p_sink.writeEmergency(p_level, p_line);
+}
+
+void CrashWriter::broadcast(const Level& p_level, std::string_view p_line) noexcept {
+    for (size_t i = 0; i < m_sink_count; ++i) {
+        send(*m_sinks[i].m_sink, p_level, p_line);
+    }
+}
+
+// CrashHandler
+
+namespace {
+
+constexpr size_t MAX_LOGGERS = 1024;
+std::atomic<Logger*> s_loggers[MAX_LOGGERS];
+
+} // namespace
+
+void CrashHandler::track(Logger* p_logger) noexcept {
+    for (auto& slot : s_loggers) {
+        Logger* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, p_logger, std::memory_order_release, std::memory_order_relaxed)) return;
+    }
+}
+
+void CrashHandler::untrack(Logger* p_logger) noexcept {
+    for (auto& slot : s_loggers) {
+        Logger* expected = p_logger;
+        if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed)) return;
+    }
+}
+
+void CrashHandler::waitWhile(const std::atomic<bool>& p_busy, std::chrono::milliseconds p_timeout) noexcept {
+#if !defined(_WIN32)
+    // Polls with nanosleep, the async-signal-safe way to wait
+    const timespec pause{0, 1000000};
+    for (int64_t waited = 0; p_busy.load(std::memory_order_acquire) && waited < p_timeout.count(); ++waited) {
+        nanosleep(&pause, nullptr);
+    }
+#else
+    (void)p_busy;
+    (void)p_timeout;
+#endif
+}
+
+#if !defined(_WIN32)
+
+namespace {
+
+constexpr int k_signals[] = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE};
+constexpr size_t SIGNAL_COUNT = sizeof(k_signals) / sizeof(k_signals[0]);
+
+std::mutex s_install_mutex;
+bool s_installed = false;
+struct sigaction s_previous[SIGNAL_COUNT];
+
+constexpr size_t ALT_STACK_SIZE = 64 * 1024;
+void* s_alt_stack = nullptr;
+
+// Thread running the crash sequence, 0 if none
+std::atomic<long> s_handling_thread{0};
+CrashWriter s_writer;
+
+long currentThread() noexcept {
+#if defined(__linux__)
+    return static_cast<long>(::syscall(SYS_gettid));
+#else
+    return static_cast<long>(reinterpret_cast<uintptr_t>(pthread_self()));
+#endif
+}
+
+// Puts the previous action back and raises p_signal again. Inside the handler the signal is
+// blocked, so it arrives once the handler returns (a fault simply happens again).
+void reraise(int p_signal) noexcept {
+    struct sigaction action{};
+    action.sa_handler = SIG_DFL;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < SIGNAL_COUNT; ++i) {
+        if (k_signals[i] == p_signal && s_previous[i].sa_handler != SIG_IGN) action = s_previous[i];
+    }
+    sigaction(p_signal, &action, nullptr);
+    raise(p_signal);
+}
+
+void onSignal(int p_signal, siginfo_t* p_info, void*) {
+    const bool fault = p_signal != SIGABRT && p_info && p_info->si_code > 0;
+    CrashHandler::handleSignal(p_signal, fault ? p_info->si_addr : nullptr);
+}
+
+} // namespace
+
+bool CrashHandler::install() {
+    std::lock_guard<std::mutex> lock(s_install_mutex);
+    if (s_installed) return true;
+
+    if (!s_alt_stack) {
+        void* stack = ::mmap(nullptr, ALT_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (stack != MAP_FAILED) {
+            stack_t alt{};
+            alt.ss_sp = stack;
+            alt.ss_size = ALT_STACK_SIZE;
+            if (sigaltstack(&alt, nullptr) == 0) {
+                s_alt_stack = stack;
+            } else {
+                ::munmap(stack, ALT_STACK_SIZE);
+            }
+        }
+    }
+
+    struct sigaction action{};
+    action.sa_sigaction = &onSignal;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+
+    for (size_t i = 0; i < SIGNAL_COUNT; ++i) {
+        if (sigaction(k_signals[i], &action, &s_previous[i]) != 0) {
+            while (i-- > 0) sigaction(k_signals[i], &s_previous[i], nullptr);
+            return false;
+        }
+    }
+    s_installed = true;
+    return true;
+}
+
+void CrashHandler::uninstall() {
+    std::lock_guard<std::mutex> lock(s_install_mutex);
+    if (!s_installed) return;
+
+    for (size_t i = 0; i < SIGNAL_COUNT; ++i) {
+        sigaction(k_signals[i], &s_previous[i], nullptr);
+    }
+    s_installed = false;
+}
+
+bool CrashHandler::isInstalled() noexcept {
+    std::lock_guard<std::mutex> lock(s_install_mutex);
+    return s_installed;
+}
+
+void CrashHandler::handleSignal(int p_signal, const void* p_address) noexcept {
+    const int savedErrno = errno;
+    const long thread = currentThread();
+
+    long expected = 0;
+    if (!s_handling_thread.compare_exchange_strong(expected, thread)) {
+        // A crash inside the crash sequence ends the process right away; any other thread
+        // waits for the one reporting to end it
+        if (expected == thread) reraise(p_signal);
+        for (;;) pause();
+    }
+
+    // Producers stop queuing, backends stop at their next record
+    s_crashing.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (auto& slot : s_loggers) {
+        if (Logger* logger = slot.load(std::memory_order_acquire)) logger->haltOnCrash();
+    }
+    for (auto& slot : s_loggers) {
+        if (Logger* logger = slot.load(std::memory_order_acquire)) logger->collectSinksOnCrash(s_writer);
+    }
+    for (auto& slot : s_loggers) {
+        if (Logger* logger = slot.load(std::memory_order_acquire)) logger->drainOnCrash(s_writer);
+    }
+    s_writer.broadcast(Level::Fatal, s_writer.renderSignal(p_signal, p_address, thread));
+
+    errno = savedErrno;
+    reraise(p_signal);
+}
+
+#else
+
+bool CrashHandler::install() {
+    return false;
+}
+
+void CrashHandler::uninstall() {}
+
+bool CrashHandler::isInstalled() noexcept {
+    return false;
+}
+
+void CrashHandler::handleSignal(int p_signal, const void*) noexcept {
+    std::raise(p_signal);
+}
+
+#endif
+
+} // namespace FZXLog::Logger
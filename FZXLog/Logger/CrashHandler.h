@@ -0,0 +1,101 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+#include "FZXLog/Sink/Sink.h"
+
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+
+namespace FZXLog::Logger {
+
+class Logger;
+
+// Renders records on the crash path into a fixed buffer and hands them to
+// Sink::writeEmergency. A sink gets its spillEmergency() call before its first line.
+class CrashWriter {
+private:
+
+    // Private types
+
+    struct Entry {
+        Sink::Sink* m_sink;
+        bool m_spilled;
+    };
+
+    // Private members
+
+    static constexpr size_t LINE_SIZE = 4096;
+    static constexpr size_t MAX_SINKS = 256;
+
+    char m_line[LINE_SIZE];
+    size_t m_size = 0;
+    Entry m_sinks[MAX_SINKS];
+    size_t m_sink_count = 0;
+
+    Entry* find(Sink::Sink* p_sink) noexcept;
+
+    void append(std::string_view p_text) noexcept;
+    void appendNumber(uint64_t p_value, int p_width = 0) noexcept;
+    void appendTimestamp(const std::chrono::system_clock::time_point& p_timestamp) noexcept;
+
+public:
+
+    // Methods
+
+    // "2026-10-17 19:17:32.123456 [Fatal] file:line message key=value", in UTC.
+    // p_message replaces the record's message, the async loggers pass the format string of
+    // logf records whose arguments were never rendered.
+    std::string_view render(const LogRecord& p_record, std::string_view p_message) noexcept;
+    // The fatal record, written after everything drained
+    std::string_view renderSignal(int p_signal, const void* p_address, long p_thread) noexcept;
+
+    // Remembers p_sink as a target of the fatal record
+    void addSink(Sink::Sink* p_sink) noexcept;
+    // Writes p_line to p_sink if p_level passes the sink level
+    void send(Sink::Sink& p_sink, const Level& p_level, std::string_view p_line) noexcept;
+    // Writes p_line to every sink added so far
+    void broadcast(const Level& p_level, std::string_view p_line) noexcept;
+};
+
+// Opt-in handler for SIGSEGV, SIGABRT, SIGBUS and SIGFPE that saves what the async loggers
+// still have queued. On a fatal signal it stops the producers and the backend threads,
+// writes every queued record through Sink::writeEmergency (write(2) on the sink's file,
+// no locks, no allocation), adds a Fatal record naming the signal, then restores the
+// previous handler and re-raises the signal.
+// Every logger is tracked from construction to destruction; install() only arms the handler.
+// Sinks without an emergency path (BinaryFileSink, Stream mode console buffering) lose what
+// they have not written yet. POSIX only: install() returns false elsewhere.
+class CrashHandler {
+private:
+
+    static inline std::atomic<bool> s_crashing{false};
+
+public:
+
+    // Installs the handler, with an alternate signal stack for the calling thread so a stack
+    // overflow there can still be reported. False if a signal action could not be set.
+    static bool install();
+    // Puts the previous handlers back
+    static void uninstall();
+    static bool isInstalled() noexcept;
+
+    // The crash sequence for p_signal, ending with the signal re-raised. Called by the
+    // installed handler; a std::terminate handler may call it with SIGABRT.
+    static void handleSignal(int p_signal, const void* p_address = nullptr) noexcept;
+
+    // True once a fatal signal is being handled, async loggers then drop new records
+    static bool isCrashing() noexcept {
+        return s_crashing.load(std::memory_order_relaxed);
+    }
+
+    // For backend threads stopping on a crash: waits while p_busy is set, at most p_timeout
+    static void waitWhile(const std::atomic<bool>& p_busy, std::chrono::milliseconds p_timeout = std::chrono::milliseconds(200)) noexcept;
+
+    // Called by the Logger constructor and destructor. Only the first 1024 loggers alive
+    // at the same time are tracked.
+    static void track(Logger* p_logger) noexcept;
+    static void untrack(Logger* p_logger) noexcept;
+};
+
+} // namespace FZXLog::Logger
@@ -0,0 +1,111 @@
+#include "FlushScheduler.h"
+#include "CrashHandler.h"
+
+namespace FZXLog::Logger {
+
+namespace {
+
+// Set on a timer thread whose scheduler was stopped, and possibly destroyed, by its own flush
+thread_local const FlushScheduler* t_abandoned = nullptr;
+
+} // namespace
+
+FlushScheduler::FlushScheduler(std::function<void()> p_flush, const Level& p_level) :
+    m_flush(std::move(p_flush)),
+    m_level(p_level)
+{}
+
+FlushScheduler::~FlushScheduler() {
+    stop();
+}
+
+void FlushScheduler::setPolicy(const FlushPolicy& p_policy) {
+    m_level.store(p_policy.m_level, std::memory_order_relaxed);
+    m_max_records.store(p_policy.m_records, std::memory_order_relaxed);
+    m_max_bytes.store(p_policy.m_bytes, std::memory_order_relaxed);
+    m_interval_ms.store(p_policy.m_interval.count(), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lk(m_timer_mutex);
+    if (p_policy.m_interval.count() > 0 && !m_timer.joinable() && !m_stop) {
+        m_timer = std::thread(&FlushScheduler::timerLoop, this);
+    }
+    m_timer_cv.notify_one();
+}
+
+FlushPolicy FlushScheduler::getPolicy() const noexcept {
+    FlushPolicy policy;
+    policy.m_level = m_level.load(std::memory_order_relaxed);
+    policy.m_records = m_max_records.load(std::memory_order_relaxed);
+    policy.m_bytes = m_max_bytes.load(std::memory_order_relaxed);
+    policy.m_interval = std::chrono::milliseconds(m_interval_ms.load(std::memory_order_relaxed));
+    return policy;
+}
+
+void FlushScheduler::flushUpTo(uint64_t p_trigger) {
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (m_covered.load(std::memory_order_relaxed) < p_trigger) {
+        if (m_flushing) {
+            m_done_cv.wait(lk);
+            continue;
+        }
+
+        // Lead a flush covering every trigger taken so far
+        m_flushing = true;
+        const uint64_t covers = m_triggered.load(std::memory_order_acquire);
+        lk.unlock();
+
+        m_pending_records.store(0, std::memory_order_relaxed);
+        m_pending_bytes.store(0, std::memory_order_relaxed);
+        try {
+            m_flush();
+        } catch (...) {}
+        if (t_abandoned == this) return;
+        m_flushes.fetch_add(1, std::memory_order_relaxed);
+
+        lk.lock();
+        m_flushing = false;
+        if (covers > m_covered.load(std::memory_order_relaxed)) {
+            m_covered.store(covers, std::memory_order_release);
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+void FlushScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lk(m_timer_mutex);
+        m_stop = true;
+    }
+    m_timer_cv.notify_one();
+    if (!m_timer.joinable()) return;
+    if (m_timer.get_id() == std::this_thread::get_id()) {
+        // Stopped from a flush on the timer thread: it cannot join itself, so it is
+        // detached and leaves without touching the scheduler again
+        t_abandoned = this;
+        m_timer.detach();
+    } else {
+        m_timer.join();
+    }
+}
+
+void FlushScheduler::timerLoop() {
+    std::unique_lock<std::mutex> lk(m_timer_mutex);
+    while (!m_stop) {
+        const int64_t interval = m_interval_ms.load(std::memory_order_relaxed);
+        if (interval <= 0) {
+            m_timer_cv.wait(lk);
+            continue;
+        }
+        if (m_timer_cv.wait_for(lk, std::chrono::milliseconds(interval), [this] { return m_stop; })) break;
+
+        if (m_pending_records.load(std::memory_order_relaxed) == 0 || CrashHandler::isCrashing()) continue;
+        lk.unlock();
+        flush();
+        if (t_abandoned == this) return;
+        lk.lock();
+    }
+}
+
+} // namespace FZXLog::Logger
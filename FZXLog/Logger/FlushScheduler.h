@@ -0,0 +1,131 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace FZXLog::Logger {
+
+// When a logger flushes its sinks. A zero count, size or interval disables that trigger.
+struct FlushPolicy {
+
+    // Public members
+
+    Level m_level = Level::Error;                  // A record at this level or above
+    uint64_t m_records = 0;                        // Records written since the last flush
+    uint64_t m_bytes = 0;                          // Message bytes written since the last flush
+    std::chrono::milliseconds m_interval{0};       // Background flush of anything written since
+};
+
+// Decides when the sinks of one logger are flushed and runs the flushes.
+// Triggers come from the records (see onRecord) and from an optional background timer.
+// Concurrent flush requests are coalesced: a caller whose trigger is already covered by a
+// running flush waits for it, the others share the next one, so a burst costs a couple of
+// flushes instead of one per record.
+class FlushScheduler {
+private:
+
+    // Private members
+
+    // Flushes the sinks, taking whatever lock the logger needs. Never call
+    // flush() while holding that lock.
+    std::function<void()> m_flush;
+
+    std::atomic<Level> m_level;
+    std::atomic<uint64_t> m_max_records{0};
+    std::atomic<uint64_t> m_max_bytes{0};
+    std::atomic<int64_t> m_interval_ms{0};
+
+    // Work written since the last flush started
+    std::atomic<uint64_t> m_pending_records{0};
+    std::atomic<uint64_t> m_pending_bytes{0};
+
+    // Group commit: every trigger takes a sequence number, a flush covers the triggers
+    // taken before it started
+    std::atomic<uint64_t> m_triggered{0};
+    std::atomic<uint64_t> m_covered{0};  // Highest trigger covered by a finished flush
+    std::mutex m_mutex;
+    std::condition_variable m_done_cv;
+    bool m_flushing = false;
+
+    std::atomic<uint64_t> m_flushes{0};
+    std::atomic<uint64_t> m_requests{0};
+
+    // Periodic flusher, started by the first policy with an interval
+    std::thread m_timer;
+    std::mutex m_timer_mutex;
+    std::condition_variable m_timer_cv;
+    bool m_stop = false;
+
+    void timerLoop();
+
+public:
+
+    // Constructor/Destructor
+
+    explicit FlushScheduler(std::function<void()> p_flush, const Level& p_level = Level::Error);
+    ~FlushScheduler();
+
+    FlushScheduler(const FlushScheduler&) = delete;
+    FlushScheduler& operator=(const FlushScheduler&) = delete;
+
+    // Methods
+
+    void setPolicy(const FlushPolicy& p_policy);
+    FlushPolicy getPolicy() const noexcept;
+
+    void setLevel(const Level& p_level) noexcept {
+        m_level.store(p_level, std::memory_order_relaxed);
+    }
+    Level getLevel() const noexcept {
+        return m_level.load(std::memory_order_relaxed);
+    }
+
+    // Accounts one written record. Returns its trigger for flushUpTo() when it makes a flush
+    // due, else 0. p_sink_flush is set when a sink asked for one through its flush level.
+    uint64_t onRecord(const Level& p_level, size_t p_bytes, bool p_sink_flush) noexcept {
+        const uint64_t records = m_pending_records.fetch_add(1, std::memory_order_relaxed) + 1;
+        const uint64_t bytes = m_pending_bytes.fetch_add(p_bytes, std::memory_order_relaxed) + p_bytes;
+
+        const uint64_t maxRecords = m_max_records.load(std::memory_order_relaxed);
+        const uint64_t maxBytes = m_max_bytes.load(std::memory_order_relaxed);
+        const bool due = p_sink_flush
+            || static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_level.load(std::memory_order_relaxed))
+            || (maxRecords > 0 && records >= maxRecords)
+            || (maxBytes > 0 && bytes >= maxBytes);
+        return due ? m_triggered.fetch_add(1, std::memory_order_acq_rel) + 1 : 0;
+    }
+
+    // Returns once a flush started after trigger p_trigger has finished, running it if needed
+    void flushUpTo(uint64_t p_trigger);
+
+    // Flushes everything written before the call
+    void flush() {
+        flushUpTo(m_triggered.fetch_add(1, std::memory_order_acq_rel) + 1);
+    }
+
+    // Covers the triggers taken so far, returns at once if there are none
+    void flushIfDue() {
+        const uint64_t trigger = m_triggered.load(std::memory_order_acquire);
+        if (trigger > m_covered.load(std::memory_order_acquire)) flushUpTo(trigger);
+    }
+
+    // Ends the timer thread, must run before m_flush becomes invalid
+    void stop();
+
+    // Flushes actually run, and flush requests (coalesced ones included)
+    uint64_t getFlushCount() const noexcept {
+        return m_flushes.load(std::memory_order_relaxed);
+    }
+    uint64_t getRequestCount() const noexcept {
+        return m_requests.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace FZXLog::Logger
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FZXLog::Logger {
+
+// Fixed-capacity circular buffer of records.
+// Slots are allocated once and overwritten in place, so a push is O(1) and reuses the
+// slot's message buffer. Guarded by its own lock so any logger type can share it.
+class LogTraceBuffer {
+private:
+
+    // Private members
+
+    std::vector<LogRecord> m_slots;
+    size_t m_head;  // Next slot to write
+    size_t m_size;
+    std::atomic<size_t> m_capacity;
+    mutable std::mutex m_mutex;
+
+    // Visits records oldest to newest, m_mutex must be held
+    template<typename Visitor>
+    void visitLocked(Visitor&& p_visitor) const {
+        const size_t capacity = m_slots.size();
+        const size_t first = (m_head + capacity - m_size) % (capacity ? capacity : 1);
+        for (size_t i = 0; i < m_size; ++i) {
+            p_visitor(m_slots[(first + i) % capacity]);
+        }
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    explicit LogTraceBuffer(size_t p_capacity = 100) :
+        m_slots(p_capacity),
+        m_head(0),
+        m_size(0),
+        m_capacity(p_capacity)
+    {}
+    ~LogTraceBuffer() = default;
+
+    LogTraceBuffer(const LogTraceBuffer&) = delete;
+    LogTraceBuffer& operator=(const LogTraceBuffer&) = delete;
+
+    // Methods
+
+    void push(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) {
+        if (m_capacity.load(std::memory_order_relaxed) == 0) return;
+
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_slots.empty()) return;
+
+        LogRecord& slot = m_slots[m_head];
+        slot.m_location = p_loc;
+        slot.m_level = p_level;
+        slot.m_message.assign(p_message);
+        slot.m_timestamp = p_timestamp;
+        slot.m_threadId = p_threadId;
+        slot.m_fields = p_fields;
+
+        m_head = (m_head + 1) % m_slots.size();
+        if (m_size < m_slots.size()) ++m_size;
+    }
+
+    // Calls p_visitor(const LogRecord&) for each record, oldest first, without copying
+    template<typename Visitor>
+    void forEach(Visitor&& p_visitor) const {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        visitLocked(p_visitor);
+    }
+
+    // Visits every record, oldest first, then empties the buffer
+    template<typename Visitor>
+    void drain(Visitor&& p_visitor) {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        visitLocked(p_visitor);
+        m_size = 0;
+    }
+
+    std::vector<LogRecord> snapshot() const {
+        std::vector<LogRecord> records;
+        std::lock_guard<std::mutex> lk(m_mutex);
+        records.reserve(m_size);
+        visitLocked([&](const LogRecord& p_record) { records.push_back(p_record); });
+        return records;
+    }
+
+    // Resizes the buffer, keeping the newest records
+    void setCapacity(size_t p_capacity) {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (p_capacity == m_slots.size()) return;
+
+        std::vector<LogRecord> slots(p_capacity);
+        const size_t kept = m_size < p_capacity ? m_size : p_capacity;
+        size_t index = 0;
+        size_t skip = m_size - kept;
+        visitLocked([&](const LogRecord& p_record) {
+            if (skip > 0) { --skip; return; }
+            slots[index++] = p_record;
+        });
+
+        m_slots = std::move(slots);
+        m_size = kept;
+        m_head = p_capacity ? kept % p_capacity : 0;
+        m_capacity.store(p_capacity, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const noexcept {
+        return m_capacity.load(std::memory_order_relaxed);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        return m_size;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_size = 0;
+    }
+};
+
+} // namespace FZXLog::Logger
@@ -5,30 +5,140 @@
 
 namespace FZXLog::Logger {
 
-void Logger::log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message) {
-    if (p_level == Level::Off || static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level))
+void Logger::log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message, const Fields& p_fields) {
+    if (!shouldLog(p_level))
         return;
 
+    dispatch(p_loc, p_level, p_message, std::chrono::system_clock::now(), std::this_thread::get_id(), p_fields);
+}
+
+void Logger::dispatch(
+    const SourceLocation& p_loc,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_threadId,
+    const Fields& p_fields
+) {
+    if (m_backtrace_enabled.load(std::memory_order_relaxed)) {
+        if (static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_backtrace_level.load(std::memory_order_relaxed))) {
+            m_backtrace.push(p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+            countRecord(p_level, false);
+            return;
+        }
+        if (static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_backtrace_dump_level.load(std::memory_order_relaxed))) {
+            dumpBacktrace();
+        }
+    }
+
+    if (static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level.load(std::memory_order_relaxed))) {
+        countRecord(p_level, false);
+        return;
+    }
+
+    if (const FilterList* filters = m_filters.load(std::memory_order_acquire)) {
+        if (!applyFilters(*filters, p_loc, p_level, p_message, p_timestamp, p_threadId)) {
+            countRecord(p_level, false);
+            return;
+        }
+    }
+    countRecord(p_level, true);
+
+    const bool sinkFlush = writeToSinks(p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+    if (const uint64_t trigger = m_flusher.onRecord(p_level, p_message.size(), sinkFlush)) {
+        onFlushDue(trigger);
+    }
+
+    m_log_trace.push(p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+}
+
+bool Logger::writeToSinks(
+    const SourceLocation& p_loc,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_threadId,
+    const Fields& p_fields
+) {
     std::unordered_set<std::shared_ptr<Sink::Sink>> sinksCopy = m_sinks;
-    const auto timestamp = std::chrono::system_clock::now();
-    const auto threadId = std::this_thread::get_id();
 
+    // Sinks sharing a formatter get the same rendered line
+    Sink::RenderCache::Scope cache;
+    bool flush = false;
     for (auto& sink : sinksCopy) {
         if (sink) {
-            sink->log(p_loc, p_level, p_message, timestamp, threadId);
+            flush |= sink->append(cache.get(), p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
         }
     }
+    return flush;
+}
 
-    if (static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_flushLevel)) {
-        flush();
+namespace {
+
+// Sends records added by a filter straight to the logger's sinks
+template<typename Write>
+class SinkEmitter : public Filter::Emitter {
+private:
+    Write& m_write;
+
+public:
+    explicit SinkEmitter(Write& p_write) noexcept : m_write(p_write) {}
+
+    void emit(
+        const SourceLocation& p_location,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id
+    ) noexcept override {
+        try {
+            m_write(p_location, p_level, p_message, p_timestamp, p_thread_id);
+        } catch (...) {}
     }
+};
 
-    if (m_log_trace_capacity > 0) {
-        m_log_trace.emplace_back(p_loc, p_level, p_message, timestamp, threadId);
-        while (m_log_trace.size() > m_log_trace_capacity) {
-            m_log_trace.erase(m_log_trace.begin());
-        }
+} // namespace
+
+bool Logger::applyFilters(
+    const FilterList& p_filters,
+    const SourceLocation& p_loc,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_threadId
+) {
+    auto write = [this](auto&&... p_args) { writeToSinks(p_args..., Fields()); };
+    SinkEmitter emitter(write);
+    for (const auto& filter : p_filters) {
+        if (!filter->filter(p_loc, p_level, p_message, p_timestamp, p_threadId, emitter))
+            return false;
+    }
+    return true;
+}
+
+void Logger::flushFilters() {
+    const FilterList* filters = m_filters.load(std::memory_order_acquire);
+    if (!filters) return;
+
+    auto write = [this](auto&&... p_args) { writeToSinks(p_args..., Fields()); };
+    SinkEmitter emitter(write);
+    for (const auto& filter : *filters) {
+        filter->flush(emitter);
+    }
+}
+
+void Logger::flushSinks() {
+    flushFilters();
+    std::unordered_set<std::shared_ptr<Sink::Sink>> sinksCopy = m_sinks;
+    for (auto& sink : sinksCopy) {
+        if (sink) sink->timedFlush();
     }
 }
 
+void Logger::dumpBacktrace() {
+    m_backtrace.drain([this](const LogRecord& p_record) {
+        writeToSinks(p_record.m_location, p_record.m_level, p_record.m_message, p_record.m_timestamp, p_record.m_threadId, p_record.m_fields);
+    });
+}
+
 } // namespace FZXLog::Logger
@@ -1,12 +1,22 @@
 #pragma once
 
 #include "FZXLog/Utils.h"
+#include "FZXLog/Stats.h"
 #include "FZXLog/Sink/Sink.h"
+#include "FZXLog/Fmt/DeferredFormat.h"
+#include "FZXLog/Filter/Filter.h"
+#include "FlushScheduler.h"
+#include "CrashHandler.h"
+#include "LogTrace.h"
 
+#include <atomic>
+#include <chrono>
 #include <format>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -16,10 +26,119 @@ namespace FZXLog::Logger {
 class Logger {
 protected:
     std::unordered_set<std::shared_ptr<Sink::Sink>> m_sinks;
-    Level m_level;
-    Level m_flushLevel;
-    std::vector<LogRecord> m_log_trace;
-    size_t m_log_trace_capacity;
+    std::atomic<Level> m_level;
+    LogTraceBuffer m_log_trace;
+    std::atomic<bool> m_deferred_format{false};
+
+    // Backtrace: records below m_backtrace_level are kept in memory only
+    // and written out when a record at m_backtrace_dump_level or above arrives
+    LogTraceBuffer m_backtrace{0};
+    std::atomic<bool> m_backtrace_enabled{false};
+    std::atomic<Level> m_backtrace_level{Level::Info};
+    std::atomic<Level> m_backtrace_dump_level{Level::Error};
+
+    // Lowest level let through the front end (Trace while backtrace is enabled)
+    std::atomic<Level> m_gate;
+
+    // Filter stage between the level check and the sinks. The list is immutable once
+    // published; replaced lists are kept until the logger is destroyed, so readers never lock.
+    using FilterList = std::vector<std::shared_ptr<Filter::Filter>>;
+    std::atomic<const FilterList*> m_filters{nullptr};
+    std::vector<std::unique_ptr<FilterList>> m_filter_lists;
+    std::mutex m_filter_mutex;
+
+    // Runs the filters, false if one of them dropped the record
+    bool applyFilters(
+        const FilterList& p_filters,
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId
+    );
+    // Lets the filters write out what they hold back, called before the sinks are flushed
+    void flushFilters();
+
+    // Statistics: accepted counters at [level], filtered at [LEVEL_COUNT + level]
+    std::atomic<bool> m_stats_enabled{false};
+    mutable ShardedCounters<2 * LEVEL_COUNT> m_stats;
+
+    // Counts a record as accepted (written to the sinks) or filtered (stopped by a level,
+    // kept only in the backtrace, or dropped by a filter)
+    void countRecord(const Level& p_level, bool p_accepted) const noexcept {
+        if (m_stats_enabled.load(std::memory_order_relaxed) && static_cast<size_t>(p_level) < LEVEL_COUNT) {
+            m_stats.add((p_accepted ? 0 : LEVEL_COUNT) + static_cast<size_t>(p_level));
+        }
+    }
+
+    void updateGate() noexcept {
+        m_gate.store(
+            m_backtrace_enabled.load(std::memory_order_relaxed) ? Level::Trace : m_level.load(std::memory_order_relaxed),
+            std::memory_order_relaxed
+        );
+    }
+
+    // Flush triggers of this logger; sinks attached to it never flush on their own
+    FlushScheduler m_flusher;
+
+    // p_trigger fired for the record just written. Flushes right away by default; loggers
+    // that dispatch under a lock flush after releasing it (see FlushScheduler::flushIfDue).
+    virtual void onFlushDue(uint64_t p_trigger) {
+        m_flusher.flushUpTo(p_trigger);
+    }
+    // The flush run by m_flusher, overridden to take the lock flushSinks() needs
+    virtual void scheduledFlush() {
+        flushSinks();
+    }
+
+    // Routes a record that passed shouldLog() through the backtrace, the sinks and the log trace
+    virtual void dispatch(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    );
+    // Hands one record to every sink, true if one of them wants a flush
+    virtual bool writeToSinks(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    );
+    virtual void flushSinks();
+
+    // Crash path, run by CrashHandler inside a signal handler: no locks, no allocation.
+    // Stops the backend thread, leaving queued records in place
+    virtual void haltOnCrash() noexcept {}
+    // Writes the queued records through p_writer
+    virtual void drainOnCrash(CrashWriter& p_writer) noexcept {
+        (void)p_writer;
+    }
+    // Adds the sinks the fatal record goes to
+    virtual void collectSinksOnCrash(CrashWriter& p_writer) noexcept {
+        for (const auto& sink : m_sinks) {
+            if (sink) p_writer.addSink(sink.get());
+        }
+    }
+    friend class CrashHandler;
+
+    // Receives logf calls captured in binary form, the base implementation formats immediately
+    virtual void logDeferred(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        std::string_view p_format,
+        Fmt::DeferredDecoder p_decoder,
+        const std::string& p_payload,
+        const Fields& p_fields
+    ) {
+        std::string message;
+        p_decoder(p_format, p_payload.data(), message);
+        log(p_loc, p_level, message, p_fields);
+    }
 
 public:
     Logger(
@@ -28,24 +147,50 @@ public:
         const size_t& p_log_trace_capacity = 100
     ) :
         m_level(p_level),
-        m_flushLevel(p_flushLevel),
-        m_log_trace_capacity(p_log_trace_capacity)
-    {}
+        m_log_trace(p_log_trace_capacity),
+        m_gate(p_level),
+        m_flusher([this] { scheduledFlush(); }, p_flushLevel)
+    {
+        CrashHandler::track(this);
+    }
 
-    virtual ~Logger() = default;
+    virtual ~Logger() {
+        CrashHandler::untrack(this);
+    }
+
+    // True if a record at p_level passes the logger level (or goes to the backtrace)
+    bool shouldLog(const Level& p_level) const noexcept {
+        if (p_level == Level::Off) return false;
+        if (static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_gate.load(std::memory_order_relaxed))) return true;
+
+        // Every logging path stops at its first failed check, so a record is counted once
+        countRecord(p_level, false);
+        return false;
+    }
 
+    // Levels are atomics, reading them never takes a lock
     virtual void setLevel(const Level& p_level) {
-        m_level = p_level;
+        m_level.store(p_level, std::memory_order_relaxed);
+        updateGate();
     }
     virtual Level getLevel() const {
-        return m_level;
+        return m_level.load(std::memory_order_relaxed);
     }
 
+    // Same as the m_level of the flush policy
     virtual void setFlushLevel(const Level& p_level) {
-        m_flushLevel = p_level;
+        m_flusher.setLevel(p_level);
     }
     virtual Level getFlushLevel() const {
-        return m_flushLevel;
+        return m_flusher.getLevel();
+    }
+
+    // Flush triggers: level, record count, message bytes and a background interval
+    void setFlushPolicy(const FlushPolicy& p_policy) {
+        m_flusher.setPolicy(p_policy);
+    }
+    FlushPolicy getFlushPolicy() const noexcept {
+        return m_flusher.getPolicy();
     }
 
     virtual void addSink(std::shared_ptr<FZXLog::Sink::Sink> p_sink) {
@@ -61,28 +206,96 @@ public:
         return std::vector<std::shared_ptr<Sink::Sink>>(m_sinks.begin(), m_sinks.end());
     }
 
-    virtual void log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message);
+    virtual void log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message, const Fields& p_fields = Fields());
     virtual void log(const Level& p_level, const std::string& p_message) {
         log(SourceLocation(), p_level, p_message);
     }
 
     virtual void flush() = 0;
     virtual std::vector<LogRecord> getLogTrace() const {
-        return m_log_trace;
+        return m_log_trace.snapshot();
     }
     virtual void setLogTraceCapacity(const size_t& p_capacity) {
-        m_log_trace_capacity = p_capacity;
-        while (m_log_trace.size() > m_log_trace_capacity) {
-            m_log_trace.erase(m_log_trace.begin());
-        }
+        m_log_trace.setCapacity(p_capacity);
     }
     virtual size_t getLogTraceCapacity() const {
-        return m_log_trace_capacity;
+        return m_log_trace.capacity();
+    }
+
+    // Visits the log trace oldest first without copying it
+    template<typename Visitor>
+    void forEachLogTrace(Visitor&& p_visitor) const {
+        m_log_trace.forEach(std::forward<Visitor>(p_visitor));
+    }
+
+    // Backtrace mode: records below p_level are kept in a ring of p_capacity records instead
+    // of reaching the sinks, and are written out when a record at p_dumpLevel or above is logged
+    void enableBacktrace(size_t p_capacity, const Level& p_level = Level::Info, const Level& p_dumpLevel = Level::Error) {
+        m_backtrace.setCapacity(p_capacity);
+        m_backtrace_level.store(p_level, std::memory_order_relaxed);
+        m_backtrace_dump_level.store(p_dumpLevel, std::memory_order_relaxed);
+        m_backtrace_enabled.store(p_capacity > 0, std::memory_order_relaxed);
+        updateGate();
+    }
+    void disableBacktrace() {
+        m_backtrace_enabled.store(false, std::memory_order_relaxed);
+        updateGate();
+        m_backtrace.clear();
+    }
+    bool isBacktraceEnabled() const noexcept {
+        return m_backtrace_enabled.load(std::memory_order_relaxed);
+    }
+    // Writes the held backtrace records to the sinks now
+    virtual void dumpBacktrace();
+
+    // Filters run in the order they were added
+    void addFilter(std::shared_ptr<Filter::Filter> p_filter) {
+        std::lock_guard<std::mutex> lk(m_filter_mutex);
+        const FilterList* current = m_filters.load(std::memory_order_relaxed);
+        auto list = std::make_unique<FilterList>(current ? *current : FilterList());
+        list->push_back(std::move(p_filter));
+        m_filters.store(list.get(), std::memory_order_release);
+        m_filter_lists.push_back(std::move(list));
+    }
+    void clearFilters() {
+        std::lock_guard<std::mutex> lk(m_filter_mutex);
+        m_filters.store(nullptr, std::memory_order_release);
+    }
+
+    // Statistics: per-level counters of the logger, see getSinks() for the sink side
+    void setStatsEnabled(bool p_enabled) noexcept {
+        m_stats_enabled.store(p_enabled, std::memory_order_relaxed);
+    }
+    bool getStatsEnabled() const noexcept {
+        return m_stats_enabled.load(std::memory_order_relaxed);
+    }
+    virtual LoggerStats getStats() const {
+        LoggerStats stats;
+        for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+            stats.m_accepted[i] = m_stats.sum(i);
+            stats.m_filtered[i] = m_stats.sum(LEVEL_COUNT + i);
+        }
+        stats.m_flushes = m_flusher.getFlushCount();
+        stats.m_flush_requests = m_flusher.getRequestCount();
+        return stats;
+    }
+    virtual void resetStats() {
+        m_stats.reset();
+    }
+
+    // Deferred formatting: logf copies its arguments and formats on the backend thread.
+    // Only useful with async loggers; arguments must be strings, numbers, enums, chrono values
+    // or DeferredCopy types, anything else is still formatted on the calling thread.
+    void setDeferredFormat(bool p_enabled) noexcept {
+        m_deferred_format.store(p_enabled, std::memory_order_relaxed);
+    }
+    bool getDeferredFormat() const noexcept {
+        return m_deferred_format.load(std::memory_order_relaxed);
     }
 
     template<typename... Args>
     void logv(const SourceLocation& p_loc, const Level& p_level, Args&&... p_args) {
-        if (p_level == Level::Off || static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level))
+        if (!shouldLog(p_level))
             return;
 
         std::ostringstream oss;
@@ -95,17 +308,38 @@ public:
         logv(SourceLocation(), p_level, std::forward<Args>(p_args)...);
     }
 
+    // Structured variant: p_fields travel with the record, see Fields
     template<typename... Args>
-    void logf(const SourceLocation& p_loc, const Level& p_level, std::format_string<Args...> p_fmtStr, Args&&... p_args) {
-        if (p_level == Level::Off || static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level))
+    void logf(const SourceLocation& p_loc, const Level& p_level, const Fields& p_fields, std::format_string<Args...> p_fmtStr, Args&&... p_args) {
+        if (!shouldLog(p_level))
             return;
 
-        log(p_loc, p_level, std::format(p_fmtStr, std::forward<Args>(p_args)...));
+        if constexpr (Fmt::isDeferrable<Args...>) {
+            if (m_deferred_format.load(std::memory_order_relaxed)) {
+                std::string& payload = Fmt::deferredScratch();
+                payload.clear();
+                Fmt::encodeDeferred(payload, p_args...);
+                logDeferred(p_loc, p_level, p_fmtStr.get(), &Fmt::decodeDeferred<Args...>, payload, p_fields);
+                return;
+            }
+        }
+
+        log(p_loc, p_level, std::format(p_fmtStr, std::forward<Args>(p_args)...), p_fields);
+    }
+
+    template<typename... Args>
+    void logf(const SourceLocation& p_loc, const Level& p_level, std::format_string<Args...> p_fmtStr, Args&&... p_args) {
+        logf(p_loc, p_level, Fields(), p_fmtStr, std::forward<Args>(p_args)...);
+    }
+
+    template<typename... Args>
+    void logf(const Level& p_level, const Fields& p_fields, std::format_string<Args...> p_fmtStr, Args&&... p_args) {
+        logf(SourceLocation(), p_level, p_fields, p_fmtStr, std::forward<Args>(p_args)...);
     }
 
     template<typename... Args>
     void logf(const Level& p_level, std::format_string<Args...> p_fmtStr, Args&&... p_args) {
-        logf(SourceLocation(), p_level, p_fmtStr, std::forward<Args>(p_args)...);
+        logf(SourceLocation(), p_level, Fields(), p_fmtStr, std::forward<Args>(p_args)...);
     }
 
     template<typename... Args> void trace(std::format_string<Args...> p_fmtStr, Args&&... p_args) { logf(Level::Trace, p_fmtStr, std::forward<Args>(p_args)...); }
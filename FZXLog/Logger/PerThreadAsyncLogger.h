@@ -0,0 +1,478 @@
+#pragma once
+
+// Async logger where every producer thread gets its own single-producer/single-consumer
+// buffer, so producers never share a cache line. The backend drains all buffers and
+// merges the records of each drain round by timestamp before writing them.
+// Buffers of exited threads are freed by the backend once they are empty.
+// With CrashHandler installed, a fatal signal writes what the buffers still hold.
+
+#include "SyncLogger.h"
+#include "SpscQueue.h"
+#include "RingQueue.h"
+#include "QueuedRecord.h"
+#include "FZXLog/Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace FZXLog::Logger {
+
+class PerThreadAsyncLogger : public SyncLogger {
+private:
+
+    // Private types
+
+    struct ThreadBuffer {
+        SpscQueue<QueuedRecord> m_queue;
+        std::atomic<bool> m_abandoned{false}; // Producer thread has exited
+        std::atomic<bool> m_closed{false};    // Logger is gone
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<uint64_t> m_blocked{0};
+
+        explicit ThreadBuffer(size_t p_capacity) : m_queue(p_capacity) {}
+    };
+
+    // Buffers owned by one thread, one per logger it has used
+    struct LocalBuffers {
+        std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> m_entries;
+
+        ~LocalBuffers() {
+            for (auto& entry : m_entries) {
+                entry.second->m_abandoned.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    static inline std::atomic<uint64_t> s_next_id{1};
+
+    // Private members
+
+    const uint64_t m_id;
+    size_t m_buffer_capacity;
+    OverflowPolicy m_policy;
+
+    // Registered buffers, m_buffers_changed tells the worker to reload them
+    mutable std::mutex m_buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    std::atomic<bool> m_buffers_changed{false};
+    QueueCounters m_retired; // Counters of reclaimed buffers
+
+    // Worker side copy of m_buffers and merge state
+    using MergeEntry = std::pair<std::chrono::system_clock::time_point, size_t>;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_active;
+    std::vector<size_t> m_remaining;
+    std::vector<MergeEntry> m_heap;
+
+    // Deepest total backlog seen by the worker
+    std::atomic<size_t> m_high_water{0};
+    // Drops at the last resetStats(), guarded by m_buffers_mutex
+    uint64_t m_dropped_base = 0;
+
+    // Set while the worker takes records out or flushes, a crash waits for it to clear
+    std::atomic<bool> m_draining{false};
+
+    std::thread m_worker;
+    std::atomic<bool> m_running{true};
+
+    // Worker wake-up, only signalled when the worker is actually sleeping
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    std::atomic<bool> m_sleeping{false};
+
+    // flush() callers waiting for the worker, only signalled when there are some
+    std::mutex m_flushedMutex;
+    std::condition_variable m_flushedCv;
+    std::atomic<size_t> m_flush_waiters{0};
+
+    void wakeWorker() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(m_wakeMutex);
+            m_wakeCv.notify_one();
+        }
+    }
+
+    // The calling thread's buffer for this logger, created on first use
+    ThreadBuffer& localBuffer() {
+        thread_local LocalBuffers t_buffers;
+        thread_local uint64_t t_last_id = 0;
+        thread_local ThreadBuffer* t_last = nullptr;
+
+        if (t_last_id == m_id) return *t_last;
+
+        ThreadBuffer* buffer = nullptr;
+        for (auto& entry : t_buffers.m_entries) {
+            if (entry.first == m_id) {
+                buffer = entry.second.get();
+                break;
+            }
+        }
+
+        if (!buffer) {
+            // Drop buffers of loggers that no longer exist
+            std::erase_if(t_buffers.m_entries, [](const auto& p_entry) {
+                return p_entry.second->m_closed.load(std::memory_order_acquire);
+            });
+
+            auto created = std::make_shared<ThreadBuffer>(m_buffer_capacity);
+            {
+                std::lock_guard lock(m_buffers_mutex);
+                m_buffers.push_back(created);
+            }
+            m_buffers_changed.store(true, std::memory_order_release);
+            t_buffers.m_entries.emplace_back(m_id, created);
+            buffer = created.get();
+        }
+
+        t_last_id = m_id;
+        t_last = buffer;
+        return *buffer;
+    }
+
+    template<typename Fill>
+    void push(Fill&& p_fill) {
+        if (CrashHandler::isCrashing()) return;
+
+        ThreadBuffer& buffer = localBuffer();
+        if (!buffer.m_queue.tryPush(p_fill)) {
+            if (m_policy == OverflowPolicy::DropNewest) {
+                buffer.m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer.m_blocked.fetch_add(1, std::memory_order_relaxed);
+            while (!buffer.m_queue.tryPush(p_fill)) {
+                wakeWorker();
+                std::this_thread::yield();
+            }
+        }
+        wakeWorker();
+    }
+
+    void reloadBuffers() {
+        if (!m_buffers_changed.exchange(false, std::memory_order_acquire)) return;
+        std::lock_guard lock(m_buffers_mutex);
+        m_active = m_buffers;
+    }
+
+    // Frees the buffers of exited threads once they are drained
+    void reclaimBuffers() {
+        bool any = false;
+        for (const auto& buffer : m_active) {
+            if (buffer->m_abandoned.load(std::memory_order_acquire) && buffer->m_queue.empty()) {
+                any = true;
+                break;
+            }
+        }
+        if (!any) return;
+
+        std::lock_guard lock(m_buffers_mutex);
+        std::erase_if(m_buffers, [this](const std::shared_ptr<ThreadBuffer>& p_buffer) {
+            if (!p_buffer->m_abandoned.load(std::memory_order_acquire) || !p_buffer->m_queue.empty()) return false;
+            m_retired.m_enqueued += p_buffer->m_queue.pushed();
+            m_retired.m_dropped += p_buffer->m_dropped.load(std::memory_order_relaxed);
+            m_retired.m_blocked += p_buffer->m_blocked.load(std::memory_order_relaxed);
+            return true;
+        });
+        m_active = m_buffers;
+    }
+
+    // Writes every record queued at the start of the round, oldest timestamp first.
+    // Returns how many were written.
+    // Called by the worker after a batch
+    void notifyFlushWaiters() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_flush_waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard lock(m_flushedMutex);
+            m_flushedCv.notify_all();
+        }
+    }
+    // Blocks until p_done() holds, woken by notifyFlushWaiters()
+    template<typename Done>
+    void waitFlushed(Done&& p_done) {
+        m_flush_waiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(m_flushedMutex);
+            m_flushedCv.wait(lock, p_done);
+        }
+        m_flush_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    size_t drainRound() {
+        m_draining.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (CrashHandler::isCrashing()) {
+            m_draining.store(false, std::memory_order_release);
+            return 0;
+        }
+
+        reloadBuffers();
+
+        m_remaining.assign(m_active.size(), 0);
+        m_heap.clear();
+
+        for (size_t i = 0; i < m_active.size(); ++i) {
+            m_remaining[i] = m_active[i]->m_queue.size();
+            if (m_remaining[i] > 0) {
+                m_heap.emplace_back(m_active[i]->m_queue.front()->m_record.m_timestamp, i);
+            }
+        }
+        std::make_heap(m_heap.begin(), m_heap.end(), std::greater<MergeEntry>());
+
+        size_t depth = 0;
+        for (size_t remaining : m_remaining) depth += remaining;
+        if (depth > m_high_water.load(std::memory_order_relaxed)) {
+            m_high_water.store(depth, std::memory_order_relaxed);
+        }
+
+        size_t count = 0;
+        if (!m_heap.empty()) {
+            std::lock_guard<std::recursive_mutex> lk(m_mutex);
+            while (!m_heap.empty() && !CrashHandler::isCrashing()) {
+                std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<MergeEntry>());
+                const size_t index = m_heap.back().second;
+                m_heap.pop_back();
+
+                SpscQueue<QueuedRecord>& queue = m_active[index]->m_queue;
+                QueuedRecord& slot = *queue.front();
+                slot.materialize();
+                const LogRecord& record = slot.m_record;
+                dispatch(record.m_location, record.m_level, record.m_message, record.m_timestamp, record.m_threadId, record.m_fields);
+                queue.pop();
+                ++count;
+
+                if (--m_remaining[index] > 0) {
+                    m_heap.emplace_back(queue.front()->m_record.m_timestamp, index);
+                    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<MergeEntry>());
+                }
+            }
+        }
+        // One flush for all the triggers of the round
+        if (CrashHandler::isCrashing()) {
+            m_draining.store(false, std::memory_order_release);
+            return count;
+        }
+        m_flusher.flushIfDue();
+
+        reclaimBuffers();
+        m_draining.store(false, std::memory_order_release);
+        if (count > 0) notifyFlushWaiters();
+        return count;
+    }
+
+    bool allEmpty() const noexcept {
+        for (const auto& buffer : m_active) {
+            if (!buffer->m_queue.empty()) return false;
+        }
+        return true;
+    }
+
+    // Worker thread loop
+    void workerLoop() {
+        for (;;) {
+            if (drainRound() > 0)
+                continue;
+
+            if (!m_running.load(std::memory_order_acquire)) {
+                reloadBuffers();
+                if (allEmpty()) break;
+                continue;
+            }
+
+            std::unique_lock lock(m_wakeMutex);
+            m_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (allEmpty() && !m_buffers_changed.load(std::memory_order_relaxed) && m_running.load(std::memory_order_acquire)) {
+                m_wakeCv.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+        // final flush
+        m_flusher.flush();
+    }
+
+protected:
+
+    void haltOnCrash() noexcept override {
+        if (std::this_thread::get_id() != m_worker.get_id()) CrashHandler::waitWhile(m_draining);
+    }
+
+    // Oldest front record first across the buffers. Reads m_buffers without its lock, a
+    // thread registering a buffer at the same moment may be missed.
+    void drainOnCrash(CrashWriter& p_writer) noexcept override {
+        const size_t bufferCount = m_buffers.size();
+        for (;;) {
+            ThreadBuffer* oldest = nullptr;
+            for (size_t i = 0; i < bufferCount; ++i) {
+                ThreadBuffer* buffer = m_buffers[i].get();
+                const QueuedRecord* front = buffer ? buffer->m_queue.front() : nullptr;
+                if (front && (!oldest || front->m_record.m_timestamp < oldest->m_queue.front()->m_record.m_timestamp)) {
+                    oldest = buffer;
+                }
+            }
+            if (!oldest) break;
+
+            const QueuedRecord& slot = *oldest->m_queue.front();
+            const LogRecord& record = slot.m_record;
+            const std::string_view line = p_writer.render(record, slot.m_decoder ? slot.m_format : std::string_view(record.m_message));
+            for (const auto& sink : m_sinks) {
+                if (sink) p_writer.send(*sink, record.m_level, line);
+            }
+            oldest->m_queue.pop();
+        }
+    }
+
+    // Stores the captured arguments in the thread's buffer, the worker formats them
+    void logDeferred(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        std::string_view p_format,
+        Fmt::DeferredDecoder p_decoder,
+        const std::string& p_payload,
+        const Fields& p_fields
+    ) override {
+        const auto timestamp = std::chrono::system_clock::now();
+        const auto threadId = std::this_thread::get_id();
+
+        push([&](QueuedRecord& p_slot) {
+            p_slot.setDeferred(p_loc, p_level, p_format, p_decoder, p_payload, timestamp, threadId, p_fields);
+        });
+    }
+
+public:
+    PerThreadAsyncLogger(const PerThreadAsyncLogger&) = delete;
+    PerThreadAsyncLogger& operator=(const PerThreadAsyncLogger&) = delete;
+    PerThreadAsyncLogger(PerThreadAsyncLogger&&) = delete;
+    PerThreadAsyncLogger& operator=(PerThreadAsyncLogger&&) = delete;
+
+    // p_buffer_capacity is per producer thread. OverwriteOldest is not available, since only
+    // the backend may pop from a buffer, and behaves like Block.
+    PerThreadAsyncLogger(
+        const Level& p_level = Level::Trace,
+        const Level& p_flushLevel = Level::Error,
+        const size_t& p_log_trace_capacity = 100,
+        const size_t& p_buffer_capacity = 1024,
+        const OverflowPolicy& p_overflow_policy = OverflowPolicy::Block
+    ) :
+        SyncLogger(p_level, p_flushLevel, p_log_trace_capacity),
+        m_id(s_next_id.fetch_add(1, std::memory_order_relaxed)),
+        m_buffer_capacity(p_buffer_capacity),
+        m_policy(p_overflow_policy == OverflowPolicy::OverwriteOldest ? OverflowPolicy::Block : p_overflow_policy)
+    {
+        m_worker = std::thread(&PerThreadAsyncLogger::workerLoop, this);
+    }
+    ~PerThreadAsyncLogger() {
+        CrashHandler::untrack(this);
+        m_flusher.stop();
+        m_running.store(false, std::memory_order_release);
+        {
+            std::lock_guard lock(m_wakeMutex);
+            m_wakeCv.notify_all();
+        }
+        if (m_worker.joinable())
+            m_worker.join();
+
+        // Threads still holding a buffer release it on their next registration or at exit
+        std::lock_guard lock(m_buffers_mutex);
+        for (const auto& buffer : m_buffers) {
+            buffer->m_closed.store(true, std::memory_order_release);
+        }
+    }
+
+    // Log a message
+    void log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message, const Fields& p_fields = Fields()) override {
+        if (!shouldLog(p_level))
+            return;
+
+        const auto timestamp = std::chrono::system_clock::now();
+        const auto threadId = std::this_thread::get_id();
+
+        push([&](QueuedRecord& p_slot) {
+            p_slot.set(p_loc, p_level, p_message, timestamp, threadId, p_fields);
+        });
+    }
+    void log(const Level& p_level, const std::string& p_message) override { log(SourceLocation(), p_level, p_message); }
+
+    // Waits until every record queued before the call has been written, then flushes the sinks
+    void flush() override {
+        if (std::this_thread::get_id() != m_worker.get_id()) {
+            std::vector<std::pair<std::shared_ptr<ThreadBuffer>, size_t>> targets;
+            {
+                std::lock_guard lock(m_buffers_mutex);
+                targets.reserve(m_buffers.size());
+                for (const auto& buffer : m_buffers) {
+                    targets.emplace_back(buffer, buffer->m_queue.pushed());
+                }
+            }
+            for (const auto& [buffer, target] : targets) {
+                if (buffer->m_queue.popped() < target) {
+                    wakeWorker();
+                    waitFlushed([&] { return buffer->m_queue.popped() >= target; });
+                }
+            }
+        }
+        SyncLogger::flush();
+    }
+
+    LoggerStats getStats() const override {
+        LoggerStats stats = SyncLogger::getStats();
+        std::lock_guard lock(m_buffers_mutex);
+        stats.m_dropped = m_retired.m_dropped;
+        for (const auto& buffer : m_buffers) {
+            stats.m_dropped += buffer->m_dropped.load(std::memory_order_relaxed);
+            stats.m_queue_depth += buffer->m_queue.size();
+        }
+        stats.m_dropped -= m_dropped_base;
+        stats.m_queue_high_water = m_high_water.load(std::memory_order_relaxed);
+        return stats;
+    }
+    void resetStats() override {
+        SyncLogger::resetStats();
+        m_high_water.store(0, std::memory_order_relaxed);
+        std::lock_guard lock(m_buffers_mutex);
+        m_dropped_base = m_retired.m_dropped;
+        for (const auto& buffer : m_buffers) {
+            m_dropped_base += buffer->m_dropped.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Queue state, summed over all thread buffers
+
+    QueueCounters getQueueCounters() {
+        std::lock_guard lock(m_buffers_mutex);
+        QueueCounters counters = m_retired;
+        for (const auto& buffer : m_buffers) {
+            counters.m_enqueued += buffer->m_queue.pushed();
+            counters.m_dropped += buffer->m_dropped.load(std::memory_order_relaxed);
+            counters.m_blocked += buffer->m_blocked.load(std::memory_order_relaxed);
+        }
+        return counters;
+    }
+    size_t getQueueSize() {
+        std::lock_guard lock(m_buffers_mutex);
+        size_t size = 0;
+        for (const auto& buffer : m_buffers) {
+            size += buffer->m_queue.size();
+        }
+        return size;
+    }
+    size_t getThreadBufferCount() {
+        std::lock_guard lock(m_buffers_mutex);
+        return m_buffers.size();
+    }
+    size_t getBufferCapacity() const noexcept {
+        return m_buffer_capacity;
+    }
+    OverflowPolicy getOverflowPolicy() const noexcept {
+        return m_policy;
+    }
+};
+
+} // namespace FZXLog::Logger
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+#include "FZXLog/Fmt/DeferredFormat.h"
+
+#include <string>
+#include <string_view>
+
+namespace FZXLog::Logger {
+
+// Queue slot used by the async loggers.
+// When m_decoder is set, m_payload holds captured logf arguments and the message
+// is rendered on the backend thread.
+struct QueuedRecord {
+
+    // Public members
+
+    LogRecord m_record;
+    Fmt::DeferredDecoder m_decoder = nullptr;
+    std::string_view m_format;
+    std::string m_payload;
+
+    // Methods
+
+    // Fills the slot with a formatted message
+    inline void set(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) {
+        m_record.m_location = p_loc;
+        m_record.m_level = p_level;
+        m_record.m_message.assign(p_message);
+        m_record.m_fields = p_fields;
+        m_record.m_timestamp = p_timestamp;
+        m_record.m_threadId = p_threadId;
+        m_decoder = nullptr;
+    }
+
+    // Fills the slot with captured logf arguments
+    inline void setDeferred(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        std::string_view p_format,
+        Fmt::DeferredDecoder p_decoder,
+        const std::string& p_payload,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) {
+        m_record.m_location = p_loc;
+        m_record.m_level = p_level;
+        m_record.m_fields = p_fields;
+        m_record.m_timestamp = p_timestamp;
+        m_record.m_threadId = p_threadId;
+        m_decoder = p_decoder;
+        m_format = p_format;
+        m_payload.assign(p_payload);
+    }
+
+    // Renders a deferred message into m_record.m_message
+    inline void materialize() {
+        if (!m_decoder) return;
+        m_record.m_message.clear();
+        try {
+            m_decoder(m_format, m_payload.data(), m_record.m_message);
+        } catch (...) {
+            m_record.m_message.assign(m_format);
+        }
+        m_decoder = nullptr;
+    }
+};
+
+} // namespace FZXLog::Logger
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace FZXLog::Logger {
+
+// What a producer does when the queue is full
+enum class OverflowPolicy : uint8_t {
+    Block           = 0,    // Wait for the consumer to free a slot
+    DropNewest      = 1,    // Discard the record being pushed
+    OverwriteOldest = 2     // Discard the oldest queued record to make room
+};
+
+struct QueueCounters {
+
+    // Public members
+
+    uint64_t m_enqueued = 0;
+    uint64_t m_dropped = 0;
+    uint64_t m_overwritten = 0;
+    uint64_t m_blocked = 0;
+};
+
+// Bounded, preallocated multi-producer ring (Vyukov sequence slots).
+// Slots are filled and drained in place, so values keep their buffers between uses.
+// Dequeue is CAS based, which lets an overwriting producer evict the oldest record
+// while the consumer is running.
+template<typename T>
+class RingQueue {
+private:
+
+    // Private members
+
+    struct alignas(64) Slot {
+        std::atomic<size_t> m_sequence{0};
+        T m_value{};
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_capacity;
+    size_t m_mask;
+    OverflowPolicy m_policy;
+
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) std::atomic<size_t> m_dequeuePos{0};
+
+    alignas(64) std::atomic<uint64_t> m_enqueued{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_overwritten{0};
+    std::atomic<uint64_t> m_blocked{0};
+
+    static size_t roundUpPow2(size_t p_value) noexcept {
+        size_t result = 2;
+        while (result < p_value) result <<= 1;
+        return result;
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    explicit RingQueue(size_t p_capacity = 8192, OverflowPolicy p_policy = OverflowPolicy::Block) :
+        m_capacity(roundUpPow2(p_capacity)),
+        m_mask(m_capacity - 1),
+        m_policy(p_policy)
+    {
+        m_slots = std::make_unique<Slot[]>(m_capacity);
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~RingQueue() = default;
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    // Methods
+
+    // Claims a slot and calls p_fill(T&) on it. Returns false if the record was dropped.
+    template<typename Fill>
+    bool tryPush(Fill&& p_fill) noexcept {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[pos & m_mask];
+            const size_t seq = slot.m_sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    p_fill(slot.m_value);
+                    slot.m_sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Pops the oldest record and calls p_drain(T&) on it. Returns false if the queue is empty.
+    template<typename Drain>
+    bool tryPop(Drain&& p_drain) noexcept {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[pos & m_mask];
+            const size_t seq = slot.m_sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    p_drain(slot.m_value);
+                    slot.m_sequence.store(pos + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Pushes according to the overflow policy.
+    // p_evicted(T&) is called on records discarded by OverwriteOldest.
+    template<typename Fill, typename Evict>
+    bool push(Fill&& p_fill, Evict&& p_evicted) noexcept {
+        if (tryPush(p_fill)) {
+            m_enqueued.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        switch (m_policy) {
+            case OverflowPolicy::DropNewest:
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+
+            case OverflowPolicy::OverwriteOldest:
+                for (;;) {
+                    if (tryPop(p_evicted)) {
+                        m_overwritten.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (tryPush(p_fill)) break;
+                    std::this_thread::yield();
+                }
+                break;
+
+            case OverflowPolicy::Block:
+            default:
+                m_blocked.fetch_add(1, std::memory_order_relaxed);
+                for (uint32_t spins = 0; !tryPush(p_fill); ++spins) {
+                    if (spins < 64) continue;
+                    std::this_thread::yield();
+                }
+                break;
+        }
+
+        m_enqueued.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // Approximate number of queued records
+    size_t size() const noexcept {
+        const size_t head = m_dequeuePos.load(std::memory_order_acquire);
+        const size_t tail = m_enqueuePos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    // Total number of slots ever claimed by producers
+    size_t enqueuePosition() const noexcept {
+        return m_enqueuePos.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const noexcept {
+        return m_capacity;
+    }
+
+    OverflowPolicy getPolicy() const noexcept {
+        return m_policy;
+    }
+
+    QueueCounters getCounters() const noexcept {
+        QueueCounters counters;
+        counters.m_enqueued = m_enqueued.load(std::memory_order_relaxed);
+        counters.m_dropped = m_dropped.load(std::memory_order_relaxed);
+        counters.m_overwritten = m_overwritten.load(std::memory_order_relaxed);
+        counters.m_blocked = m_blocked.load(std::memory_order_relaxed);
+        return counters;
+    }
+};
+
+} // namespace FZXLog::Logger
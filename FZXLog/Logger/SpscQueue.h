@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace FZXLog::Logger {
+
+// Bounded, preallocated single-producer/single-consumer ring.
+// Each side caches the other side's index, so in the common case a push or pop
+// touches only the caller's own cache line.
+template<typename T>
+class SpscQueue {
+private:
+
+    // Private members
+
+    std::unique_ptr<T[]> m_slots;
+    size_t m_capacity;
+    size_t m_mask;
+
+    // Consumer side
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_cached_tail = 0;
+
+    // Producer side
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_cached_head = 0;
+
+    static size_t roundUpPow2(size_t p_value) noexcept {
+        size_t result = 2;
+        while (result < p_value) result <<= 1;
+        return result;
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    explicit SpscQueue(size_t p_capacity = 1024) :
+        m_slots(std::make_unique<T[]>(roundUpPow2(p_capacity))),
+        m_capacity(roundUpPow2(p_capacity)),
+        m_mask(m_capacity - 1)
+    {}
+    ~SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Methods
+
+    // Producer: fills the next slot with p_fill(T&), false if the queue is full
+    template<typename Fill>
+    bool tryPush(Fill&& p_fill) noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cached_head >= m_capacity) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail - m_cached_head >= m_capacity) return false;
+        }
+        p_fill(m_slots[tail & m_mask]);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: oldest record, or nullptr if the queue is empty
+    T* front() noexcept {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cached_tail) return nullptr;
+        }
+        return &m_slots[head & m_mask];
+    }
+
+    // Consumer: releases the record returned by front()
+    void pop() noexcept {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // Approximate number of queued records
+    size_t size() const noexcept {
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    // Records pushed and popped so far
+    size_t pushed() const noexcept {
+        return m_tail.load(std::memory_order_acquire);
+    }
+    size_t popped() const noexcept {
+        return m_head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const noexcept {
+        return m_capacity;
+    }
+};
+
+} // namespace FZXLog::Logger
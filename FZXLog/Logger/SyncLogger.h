@@ -17,6 +17,13 @@ class SyncLogger : public Logger {
 protected:
     mutable std::recursive_mutex m_mutex;
 
+    // Flushes run after m_mutex is released, so threads hitting a trigger together share one
+    void onFlushDue(uint64_t) override {}
+    void scheduledFlush() override {
+        std::lock_guard<std::recursive_mutex> lk(m_mutex);
+        flushSinks();
+    }
+
 public:
 
     // Constructor/Destructor
@@ -28,44 +35,14 @@ public:
     ) :
         Logger(p_level, p_flushLevel, p_log_trace_capacity)
     {}
-    virtual ~SyncLogger() override = default;
-
-    // Getters/Setters
-
-    void setLevel(const Level& p_level) override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        m_level = p_level;
-    }
-    Level getLevel() const override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        return m_level;
-    }
-
-    void setFlushLevel(const Level& p_level) override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        m_flushLevel = p_level;
-    }
-    Level getFlushLevel() const override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        return m_flushLevel;
+    virtual ~SyncLogger() override {
+        m_flusher.stop();
     }
 
-    std::vector<LogRecord> getLogTrace() const override {
+    // Backtrace
+    void dumpBacktrace() override {
         std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        return m_log_trace;
-    }
-
-    void setLogTraceCapacity(const size_t& p_capacity) override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        m_log_trace_capacity = p_capacity;
-        while (m_log_trace.size() > m_log_trace_capacity) {
-            m_log_trace.erase(m_log_trace.begin());
-        }
-    }
-
-    size_t getLogTraceCapacity() const override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        return m_log_trace_capacity;
+        Logger::dumpBacktrace();
     }
 
     // Sink management
@@ -92,19 +69,21 @@ public:
     }
 
     // Raw log
-    void log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message) override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        Logger::log(p_loc, p_level, p_message);
+    void log(const SourceLocation& p_loc, const Level& p_level, const std::string& p_message, const Fields& p_fields = Fields()) override {
+        if (!shouldLog(p_level))
+            return;
+
+        {
+            std::lock_guard<std::recursive_mutex> lk(m_mutex);
+            Logger::log(p_loc, p_level, p_message, p_fields);
+        }
+        m_flusher.flushIfDue();
     }
     void log(const Level& p_level, const std::string& p_message) override { log(SourceLocation(), p_level, p_message); }
 
     // Flush sinks
     void flush() override {
-        std::lock_guard<std::recursive_mutex> lk(m_mutex);
-        std::unordered_set<std::shared_ptr<Sink::Sink>> sinksCopy = m_sinks;
-        for (auto& sink : sinksCopy) {
-            if (sink) sink->flush();
-        }
+        m_flusher.flush();
     }
 
 };
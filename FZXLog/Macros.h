@@ -0,0 +1,107 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+#include "FZXLog/CallSite.h"
+
+#include <source_location>
+
+// Compile-time level stripping
+// Calls below FZXLOG_ACTIVE_LEVEL expand to nothing, their arguments are never evaluated.
+// Example: add_compile_definitions(FZXLOG_ACTIVE_LEVEL=FZXLOG_ACTIVE_LEVEL_INFO)
+
+#define FZXLOG_ACTIVE_LEVEL_TRACE   0
+#define FZXLOG_ACTIVE_LEVEL_DEBUG   1
+#define FZXLOG_ACTIVE_LEVEL_INFO    2
+#define FZXLOG_ACTIVE_LEVEL_WARNING 3
+#define FZXLOG_ACTIVE_LEVEL_ERROR   4
+#define FZXLOG_ACTIVE_LEVEL_FATAL   5
+#define FZXLOG_ACTIVE_LEVEL_OFF     6
+
+#ifndef FZXLOG_ACTIVE_LEVEL
+#define FZXLOG_ACTIVE_LEVEL FZXLOG_ACTIVE_LEVEL_TRACE
+#endif
+
+#define FZXLOG_EXPAND_(p_x) p_x
+#define FZXLOG_FIRST_ARG_(p_first, ...) p_first
+
+// Expansion shared by the logging macros. p_site_level is the level stored in the
+// CallSite and must be a constant, Level::Off when the level is only known at runtime.
+#define FZXLOG_LOG_AT_(p_logger, p_site_level, p_level, ...) \
+    FZXLOG_LOG_FIELDS_AT_(p_logger, p_site_level, p_level, FZXLog::Fields(), __VA_ARGS__)
+
+#define FZXLOG_LOG_FIELDS_AT_(p_logger, p_site_level, p_level, p_fields, ...) \
+    do { \
+        static constinit FZXLog::CallSite fzxlog_site_( \
+            FZXLog::fileBasename(std::source_location::current().file_name()), \
+            std::source_location::current().line(), \
+            std::source_location::current().function_name(), \
+            p_site_level, \
+            FZXLOG_EXPAND_(FZXLOG_FIRST_ARG_(__VA_ARGS__, 0)) \
+        ); \
+        FZXLog::CallSiteRegistry::ensureRegistered(fzxlog_site_); \
+        auto&& fzxlog_logger_ = (p_logger); \
+        const FZXLog::Level fzxlog_level_ = (p_level); \
+        if (fzxlog_logger_->shouldLog(fzxlog_level_) && fzxlog_site_.hit()) { \
+            fzxlog_logger_->logf(FZXLog::SourceLocation(fzxlog_site_), fzxlog_level_, p_fields, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// Logs through a logger pointer (raw or smart) with a format string, p_level may be
+// a runtime value. Each expansion owns a constant-initialized CallSite that counts hits
+// and can be switched off at runtime (see CallSiteRegistry). The arguments are only
+// evaluated when the level check passes and the site is enabled.
+#define FZXLOG_LOG(p_logger, p_level, ...) \
+    FZXLOG_LOG_AT_(p_logger, FZXLog::Level::Off, p_level, __VA_ARGS__)
+
+// Same with key/value fields, evaluated only when the record is logged.
+// Wrap a braced field list in parentheses: FZXLOG_INFO_WITH(logger, (FZXLog::Fields{{"id", 7}}), "done")
+#define FZXLOG_LOG_WITH(p_logger, p_level, p_fields, ...) \
+    FZXLOG_LOG_FIELDS_AT_(p_logger, FZXLog::Level::Off, p_level, p_fields, __VA_ARGS__)
+
+#if FZXLOG_ACTIVE_LEVEL <= FZXLOG_ACTIVE_LEVEL_TRACE
+#define FZXLOG_TRACE(p_logger, ...) FZXLOG_LOG_AT_(p_logger, FZXLog::Level::Trace, FZXLog::Level::Trace, __VA_ARGS__)
+#define FZXLOG_TRACE_WITH(p_logger, p_fields, ...) FZXLOG_LOG_FIELDS_AT_(p_logger, FZXLog::Level::Trace, FZXLog::Level::Trace, p_fields, __VA_ARGS__)
+#else
+#define FZXLOG_TRACE(p_logger, ...) ((void)0)
+#define FZXLOG_TRACE_WITH(p_logger, p_fields, ...) ((void)0)
+#endif
+
+#if FZXLOG_ACTIVE_LEVEL <= FZXLOG_ACTIVE_LEVEL_DEBUG
+#define FZXLOG_DEBUG(p_logger, ...) FZXLOG_LOG_AT_(p_logger, FZXLog::Level::Debug, FZXLog::Level::Debug, __VA_ARGS__)
+#define FZXLOG_DEBUG_WITH(p_logger, p_fields, ...) FZXLOG_LOG_FIELDS_AT_(p_logger, FZXLog::Level::Debug, FZXLog::Level::Debug, p_fields, __VA_ARGS__)
+#else
+#define FZXLOG_DEBUG(p_logger, ...) ((void)0)
+#define FZXLOG_DEBUG_WITH(p_logger, p_fields, ...) ((void)0)
+#endif
+
+#if FZXLOG_ACTIVE_LEVEL <= FZXLOG_ACTIVE_LEVEL_INFO
+#define FZXLOG_INFO(p_logger, ...) FZXLOG_LOG_AT_(p_logger, FZXLog::Level::Info, FZXLog::Level::Info, __VA_ARGS__)
+#define FZXLOG_INFO_WITH(p_logger, p_fields, ...) FZXLOG_LOG_FIELDS_AT_(p_logger, FZXLog::Level::Info, FZXLog::Level::Info, p_fields, __VA_ARGS__)
+#else
+#define FZXLOG_INFO(p_logger, ...) ((void)0)
+#define FZXLOG_INFO_WITH(p_logger, p_fields, ...) ((void)0)
+#endif
+
+#if FZXLOG_ACTIVE_LEVEL <= FZXLOG_ACTIVE_LEVEL_WARNING
+#define FZXLOG_WARNING(p_logger, ...) FZXLOG_LOG_AT_(p_logger, FZXLog::Level::Warning, FZXLog::Level::Warning, __VA_ARGS__)
+#define FZXLOG_WARNING_WITH(p_logger, p_fields, ...) FZXLOG_LOG_FIELDS_AT_(p_logger, FZXLog::Level::Warning, FZXLog::Level::Warning, p_fields, __VA_ARGS__)
+#else
+#define FZXLOG_WARNING(p_logger, ...) ((void)0)
+#define FZXLOG_WARNING_WITH(p_logger, p_fields, ...) ((void)0)
+#endif
+
+#if FZXLOG_ACTIVE_LEVEL <= FZXLOG_ACTIVE_LEVEL_ERROR
+#define FZXLOG_ERROR(p_logger, ...) FZXLOG_LOG_AT_(p_logger, FZXLog::Level::Error, FZXLog::Level::Error, __VA_ARGS__)
+#define FZXLOG_ERROR_WITH(p_logger, p_fields, ...) FZXLOG_LOG_FIELDS_AT_(p_logger, FZXLog::Level::Error, FZXLog::Level::Error, p_fields, __VA_ARGS__)
+#else
+#define FZXLOG_ERROR(p_logger, ...) ((void)0)
+#define FZXLOG_ERROR_WITH(p_logger, p_fields, ...) ((void)0)
+#endif
+
+#if FZXLOG_ACTIVE_LEVEL <= FZXLOG_ACTIVE_LEVEL_FATAL
+#define FZXLOG_FATAL(p_logger, ...) FZXLOG_LOG_AT_(p_logger, FZXLog::Level::Fatal, FZXLog::Level::Fatal, __VA_ARGS__)
+#define FZXLOG_FATAL_WITH(p_logger, p_fields, ...) FZXLOG_LOG_FIELDS_AT_(p_logger, FZXLog::Level::Fatal, FZXLog::Level::Fatal, p_fields, __VA_ARGS__)
+#else
+#define FZXLOG_FATAL(p_logger, ...) ((void)0)
+#define FZXLOG_FATAL_WITH(p_logger, p_fields, ...) ((void)0)
+#endif
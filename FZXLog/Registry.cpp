@@ -0,0 +1,281 @@
+#include "Registry.h"
+#include "FZXLog/Logger/ConcurrentLogger.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+
+namespace FZXLog {
+
+namespace {
+
+struct Node {
+    std::string m_name;
+    Node* m_parent = nullptr;
+    std::vector<Node*> m_children;
+    bool m_has_level = false;
+    Level m_level = Level::Trace;
+    Level m_effective = Level::Trace; // Own level or the inherited one, mirrored in m_logger
+
+    // Created on the first get(), levels set before that wait in the node
+    std::shared_ptr<Logger::Logger> m_logger;
+    std::atomic<bool> m_created{false};
+};
+
+// Open-addressing table of nodes. Slots are only ever filled, so readers probe without
+// locking; a full table is replaced by one twice the size and kept, so readers still
+// holding it stay valid (the sizes add up to less than twice the last one).
+struct Table {
+    size_t m_mask;
+    std::unique_ptr<std::atomic<Node*>[]> m_slots;
+
+    explicit Table(size_t p_size) : m_mask(p_size - 1), m_slots(new std::atomic<Node*>[p_size]) {
+        for (size_t i = 0; i < p_size; ++i) m_slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    Node* find(std::string_view p_name) const noexcept {
+        for (size_t i = std::hash<std::string_view>{}(p_name) & m_mask;; i = (i + 1) & m_mask) {
+            Node* node = m_slots[i].load(std::memory_order_acquire);
+            if (!node || node->m_name == p_name) return node;
+        }
+    }
+
+    void insert(Node* p_node) noexcept {
+        for (size_t i = std::hash<std::string_view>{}(p_node->m_name) & m_mask;; i = (i + 1) & m_mask) {
+            if (!m_slots[i].load(std::memory_order_relaxed)) {
+                m_slots[i].store(p_node, std::memory_order_release);
+                return;
+            }
+        }
+    }
+};
+
+struct State {
+    std::atomic<const Table*> m_table{nullptr};
+    std::vector<std::unique_ptr<Table>> m_tables;
+    std::vector<std::unique_ptr<Node>> m_nodes;
+    std::mutex m_mutex;
+    Registry::Factory m_factory;
+
+    State() {
+        m_factory = [](const std::string&) { return std::make_shared<Logger::ConcurrentLogger>(); };
+        m_tables.push_back(std::make_unique<Table>(64));
+        m_table.store(m_tables.back().get(), std::memory_order_release);
+    }
+
+    ~State() {
+        // Loggers flush their sinks as they go, children first
+        for (auto it = m_nodes.rbegin(); it != m_nodes.rend(); ++it) {
+            (*it)->m_logger.reset();
+        }
+    }
+
+    // Caller holds m_mutex
+    void add(std::unique_ptr<Node> p_node) {
+        Table* table = m_tables.back().get();
+        if ((m_nodes.size() + 1) * 2 > table->m_mask + 1) {
+            auto grown = std::make_unique<Table>((table->m_mask + 1) * 2);
+            for (const auto& node : m_nodes) grown->insert(node.get());
+            m_tables.push_back(std::move(grown));
+            table = m_tables.back().get();
+            table->insert(p_node.get());
+            m_table.store(table, std::memory_order_release);
+        } else {
+            table->insert(p_node.get());
+        }
+        m_nodes.push_back(std::move(p_node));
+    }
+
+    // Finds or creates p_name and its parents, without their loggers. Caller holds m_mutex.
+    Node* node(std::string_view p_name) {
+        if (Node* found = m_tables.back()->find(p_name)) return found;
+
+        Node* parent = nullptr;
+        if (!p_name.empty()) {
+            const size_t dot = p_name.rfind('.');
+            parent = node(dot == std::string_view::npos ? std::string_view() : p_name.substr(0, dot));
+        }
+
+        auto created = std::make_unique<Node>();
+        created->m_name = std::string(p_name);
+        created->m_parent = parent;
+        if (parent) created->m_effective = parent->m_effective;
+
+        Node* result = created.get();
+        add(std::move(created));
+        if (parent) parent->m_children.push_back(result);
+        return result;
+    }
+
+    // The logger of p_node, created with those of its parents on first use. Caller holds m_mutex.
+    const std::shared_ptr<Logger::Logger>& logger(Node& p_node) {
+        if (p_node.m_created.load(std::memory_order_relaxed)) return p_node.m_logger;
+
+        p_node.m_logger = m_factory(p_node.m_name);
+        if (p_node.m_parent) {
+            for (const auto& sink : logger(*p_node.m_parent)->getSinks()) {
+                p_node.m_logger->addSink(sink);
+            }
+        } else if (!p_node.m_has_level) {
+            // The root always has a level, the factory's default unless one was set
+            p_node.m_has_level = true;
+            p_node.m_level = p_node.m_logger->getLevel();
+        }
+        propagate(p_node);
+
+        p_node.m_created.store(true, std::memory_order_release);
+        return p_node.m_logger;
+    }
+
+    // Pushes the effective level of p_node down to the descendants that follow it. Until
+    // the root logger exists the root may have no level yet, its followers are then
+    // updated when it is created.
+    void propagate(Node& p_node) {
+        if (p_node.m_has_level) {
+            p_node.m_effective = p_node.m_level;
+        } else if (p_node.m_parent) {
+            p_node.m_effective = p_node.m_parent->m_effective;
+        }
+        if (p_node.m_logger) p_node.m_logger->setLevel(p_node.m_effective);
+        for (Node* child : p_node.m_children) {
+            if (!child->m_has_level) propagate(*child);
+        }
+    }
+
+    void setLevel(std::string_view p_name, const Level& p_level) {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        Node* target = node(p_name);
+        target->m_has_level = true;
+        target->m_level = p_level;
+        propagate(*target);
+    }
+
+    size_t configure(std::string_view p_spec) {
+        size_t applied = 0;
+        size_t start = 0;
+        while (start <= p_spec.size()) {
+            size_t end = p_spec.find_first_of(",;\n", start);
+            if (end == std::string_view::npos) end = p_spec.size();
+            std::string_view entry = p_spec.substr(start, end - start);
+            start = end + 1;
+
+            const auto trim = [](std::string_view p_text) {
+                const size_t first = p_text.find_first_not_of(" \t\r");
+                if (first == std::string_view::npos) return std::string_view();
+                return p_text.substr(first, p_text.find_last_not_of(" \t\r") - first + 1);
+            };
+
+            std::string_view name;
+            std::string_view levelText = entry;
+            const size_t equals = entry.find('=');
+            if (equals != std::string_view::npos) {
+                name = trim(entry.substr(0, equals));
+                levelText = entry.substr(equals + 1);
+            }
+
+            Level level;
+            if (!FZXLogLevelFromString(trim(levelText), level)) continue;
+            setLevel(name, level);
+            ++applied;
+        }
+        return applied;
+    }
+};
+
+State& state() {
+    static State s_state;
+    // Startup levels, applied once before the first lookup returns
+    static const size_t s_configured = [] {
+        const char* spec = std::getenv("FZXLOG_LEVELS");
+        return spec ? s_state.configure(spec) : 0;
+    }();
+    (void)s_configured;
+    return s_state;
+}
+
+} // namespace
+
+std::shared_ptr<Logger::Logger> Registry::get(std::string_view p_name) {
+    State& registry = state();
+    if (Node* found = registry.m_table.load(std::memory_order_acquire)->find(p_name)) {
+        if (found->m_created.load(std::memory_order_acquire)) return found->m_logger;
+    }
+
+    std::lock_guard<std::mutex> lk(registry.m_mutex);
+    return registry.logger(*registry.node(p_name));
+}
+
+void Registry::setLevel(std::string_view p_name, const Level& p_level) {
+    state().setLevel(p_name, p_level);
+}
+
+void Registry::resetLevel(std::string_view p_name) {
+    State& registry = state();
+    std::lock_guard<std::mutex> lk(registry.m_mutex);
+    Node* target = registry.node(p_name);
+    if (!target->m_parent) return;
+    target->m_has_level = false;
+    registry.propagate(*target);
+}
+
+Level Registry::getEffectiveLevel(std::string_view p_name) {
+    return get(p_name)->getLevel();
+}
+
+size_t Registry::configure(std::string_view p_spec) {
+    return state().configure(p_spec);
+}
+
+size_t Registry::configureFromEnv(const char* p_variable) {
+    const char* value = std::getenv(p_variable);
+    return value ? configure(value) : 0;
+}
+
+size_t Registry::configureFromFile(const std::string& p_path) {
+    std::ifstream file(p_path);
+    if (!file) return 0;
+
+    std::string spec;
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) line.resize(comment);
+        spec.append(line);
+        spec.push_back('\n');
+    }
+    return configure(spec);
+}
+
+void Registry::setFactory(Factory p_factory) {
+    State& registry = state();
+    std::lock_guard<std::mutex> lk(registry.m_mutex);
+    registry.m_factory = std::move(p_factory);
+}
+
+std::vector<std::string> Registry::names() {
+    State& registry = state();
+    std::lock_guard<std::mutex> lk(registry.m_mutex);
+    std::vector<std::string> result;
+    result.reserve(registry.m_nodes.size());
+    for (const auto& node : registry.m_nodes) {
+        result.push_back(node->m_name);
+    }
+    return result;
+}
+
+void Registry::flushAll() {
+    std::vector<std::shared_ptr<Logger::Logger>> loggers;
+    {
+        State& registry = state();
+        std::lock_guard<std::mutex> lk(registry.m_mutex);
+        for (const auto& node : registry.m_nodes) {
+            if (node->m_logger) loggers.push_back(node->m_logger);
+        }
+    }
+    for (const auto& logger : loggers) {
+        logger->flush();
+    }
+}
+
+} // namespace FZXLog
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+#include "FZXLog/Logger/Logger.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FZXLog {
+
+// Process-wide tree of named loggers. Names are dotted paths ("net.http.client"), every
+// prefix is a parent and "" is the root. A logger without a level of its own follows its
+// nearest ancestor that has one. That effective level is stored in the logger itself, so
+// the logging path still checks a single atomic, and it is only recomputed when a level
+// above it changes. Change levels through the registry, not on the loggers directly.
+// Looking up an existing logger never takes a lock. On first use the registry applies the
+// levels found in FZXLOG_LEVELS (see configure()). Levels only create the names, a logger
+// is created by the first get() of its name or of a descendant.
+class Registry {
+public:
+
+    using Factory = std::function<std::shared_ptr<Logger::Logger>(const std::string& p_name)>;
+
+    // The logger named p_name, created together with its missing parents on first use.
+    // A new logger comes from the factory and starts with its parent's sinks.
+    static std::shared_ptr<Logger::Logger> get(std::string_view p_name);
+    static std::shared_ptr<Logger::Logger> root() {
+        return get("");
+    }
+
+    // Gives p_name a level of its own, descendants without one follow it
+    static void setLevel(std::string_view p_name, const Level& p_level);
+    // Makes p_name follow its parent again (the root keeps its level)
+    static void resetLevel(std::string_view p_name);
+    static Level getEffectiveLevel(std::string_view p_name);
+
+    // Applies a level spec: entries "name=level" or a bare "level" for the root, separated by
+    // ',', ';' or new lines, e.g. "warn,net=info,net.http.client=trace". Level names ignore case.
+    // Entries that do not parse are skipped. Returns the number applied.
+    static size_t configure(std::string_view p_spec);
+    // The same from an environment variable, or from a file with '#' comments
+    static size_t configureFromEnv(const char* p_variable = "FZXLOG_LEVELS");
+    static size_t configureFromFile(const std::string& p_path);
+
+    // Creates the loggers that get() makes after the call, a ConcurrentLogger by default.
+    // Names that only received a level so far (FZXLOG_LEVELS included) get theirs from it.
+    static void setFactory(Factory p_factory);
+
+    static std::vector<std::string> names();
+    static void flushAll();
+};
+
+} // namespace FZXLog
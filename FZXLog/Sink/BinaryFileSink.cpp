@@ -0,0 +1,136 @@
+#include "BinaryFileSink.h"
+
+#include <filesystem>
+#include <sstream>
+
+namespace FZXLog::Sink {
+
+BinaryFileSink_st::BinaryFileSink_st(
+    const std::string& p_filename,
+    const Level& p_level,
+    const Level& p_flush_level,
+    size_t p_buffer_size
+) noexcept :
+    Sink(nullptr, p_level, p_flush_level),
+    m_filename(p_filename),
+    m_buffer_size(p_buffer_size),
+    m_last_ns(0)
+{
+    try {
+        std::filesystem::path path(m_filename);
+        if (!path.parent_path().empty()) {
+            std::filesystem::create_directories(path.parent_path());
+        }
+        m_buffer.reserve(m_buffer_size + 1024);
+
+        if (!m_file.open(m_filename)) return;
+
+        // Every writer starts a new session, ids from earlier runs do not carry over
+        const size_t frame = Binary::beginFrame(m_buffer, Binary::RecordType::Session);
+        m_buffer.append(Binary::MAGIC, sizeof(Binary::MAGIC));
+        m_buffer.push_back(static_cast<char>(Binary::VERSION));
+        Binary::endFrame(m_buffer, frame);
+    } catch (...) {}
+}
+
+BinaryFileSink_st::~BinaryFileSink_st() {
+    drain();
+}
+
+uint32_t BinaryFileSink_st::internLocation(const SourceLocation& p_loc) {
+    const auto found = m_locations.find(p_loc.m_site);
+    if (found != m_locations.end()) return found->second;
+
+    const uint32_t id = static_cast<uint32_t>(m_locations.size());
+    const size_t frame = Binary::beginFrame(m_buffer, Binary::RecordType::Location);
+    Binary::putVarint(m_buffer, id);
+    Binary::putVarint(m_buffer, p_loc.line());
+    m_buffer.append(p_loc.file() ? p_loc.file() : "");
+    m_buffer.push_back('\0');
+    m_buffer.append(p_loc.function() ? p_loc.function() : "");
+    m_buffer.push_back('\0');
+    Binary::endFrame(m_buffer, frame);
+
+    m_locations.emplace(p_loc.m_site, id);
+    return id;
+}
+
+uint32_t BinaryFileSink_st::internThread(const std::thread::id& p_threadId) {
+    const auto found = m_threads.find(p_threadId);
+    if (found != m_threads.end()) return found->second;
+
+    std::ostringstream oss;
+    oss << p_threadId;
+
+    const uint32_t id = static_cast<uint32_t>(m_threads.size());
+    const size_t frame = Binary::beginFrame(m_buffer, Binary::RecordType::Thread);
+    Binary::putVarint(m_buffer, id);
+    m_buffer.append(oss.str());
+    Binary::endFrame(m_buffer, frame);
+
+    m_threads.emplace(p_threadId, id);
+    return id;
+}
+
+void BinaryFileSink_st::write(
+    const SourceLocation& p_loc,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_threadId,
+    const Fields& p_fields
+) noexcept {
+    if (!m_file.is_open()) return;
+
+    // Only whole frames stay in the buffer; interned definitions are kept even if the record fails
+    size_t complete = m_buffer.size();
+    try {
+        const uint32_t location = internLocation(p_loc);
+        complete = m_buffer.size();
+        const uint32_t thread = internThread(p_threadId);
+        complete = m_buffer.size();
+
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(p_timestamp.time_since_epoch()).count();
+
+        const size_t frame = Binary::beginFrame(m_buffer, p_fields.empty() ? Binary::RecordType::Log : Binary::RecordType::FieldsLog);
+        Binary::putVarint(m_buffer, Binary::zigzag(ns - m_last_ns));
+        m_buffer.push_back(static_cast<char>(p_level));
+        Binary::putVarint(m_buffer, location);
+        Binary::putVarint(m_buffer, thread);
+        size_t room = Binary::MAX_PAYLOAD_SIZE - 64;
+        if (!p_fields.empty()) {
+            // Fields that don't fit are dropped rather than cut
+            const std::string& fields = p_fields.data();
+            const size_t size = fields.size() < room / 2 ? fields.size() : 0;
+            Binary::putVarint(m_buffer, size);
+            m_buffer.append(fields, 0, size);
+            room -= size;
+        }
+        m_buffer.append(p_message, 0, room);
+        Binary::endFrame(m_buffer, frame);
+
+        m_last_ns = ns;
+    } catch (...) {
+        m_buffer.resize(complete);
+        return;
+    }
+
+    if (m_buffer.size() >= m_buffer_size) {
+        drain();
+    }
+}
+
+void BinaryFileSink_st::drain() noexcept {
+    if (m_buffer.empty()) return;
+
+    if (m_file.write(m_buffer.data(), m_buffer.size())) {
+        recordBytes(m_buffer.size());
+    }
+    m_buffer.clear();
+}
+
+void BinaryFileSink_st::flush() noexcept {
+    drain();
+}
+
+} // namespace FZXLog::Sink
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Sink.h"
+#include "FileHandle.h"
+#include "BinaryFormat.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace FZXLog::Sink {
+
+// Writes records in the compact binary layout of BinaryFormat.h instead of text.
+// Source locations and threads are written once and referenced by id afterwards, and
+// no formatter runs on the logging path; fzxlog-decode renders the file later.
+class BinaryFileSink_st : public Sink {
+private:
+
+    // Private members
+
+    std::string m_filename;
+    FileHandle m_file;
+    std::string m_buffer;
+    size_t m_buffer_size;
+
+    // Interning tables of the current session, call sites are keyed by address
+    std::unordered_map<const CallSite*, uint32_t> m_locations;
+    std::unordered_map<std::thread::id, uint32_t> m_threads;
+    int64_t m_last_ns;
+
+    uint32_t internLocation(const SourceLocation& p_loc);
+    uint32_t internThread(const std::thread::id& p_threadId);
+    void drain() noexcept;
+
+protected:
+
+    // Methods
+
+    virtual void write(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override;
+
+public:
+
+    // Constructor/Destructor
+
+    BinaryFileSink_st(
+        const std::string& p_filename,
+        const Level& p_level = Level::Trace,
+        const Level& p_flush_level = Level::Error,
+        size_t p_buffer_size = 64 * 1024 // 64 KiB
+    ) noexcept;
+    virtual ~BinaryFileSink_st() override;
+
+    // Methods
+
+    virtual void flush() noexcept override;
+};
+
+class BinaryFileSink_mt : public BinaryFileSink_st {
+private:
+
+    // Mutex for thread safety
+
+    mutable std::mutex m_mutex;
+
+protected:
+
+    // Protected methods
+
+    virtual void write(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        BinaryFileSink_st::write(p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    BinaryFileSink_mt(
+        const std::string& p_filename,
+        const Level& p_level = Level::Trace,
+        const Level& p_flush_level = Level::Error,
+        size_t p_buffer_size = 64 * 1024 // 64 KiB
+    ) noexcept :
+        BinaryFileSink_st(p_filename, p_level, p_flush_level, p_buffer_size)
+    {}
+    virtual ~BinaryFileSink_mt() override = default;
+
+    // Public methods
+
+    virtual void flush() noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        BinaryFileSink_st::flush();
+    }
+};
+
+} // namespace FZXLog::Sink
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Binary log layout shared by BinaryFileSink and fzxlog-decode.
+//
+// A file is a sequence of frames: [u32 payload length][u32 crc32 of payload][payload],
+// integers little endian. The first payload byte is the record type:
+//   Session   'F' 'Z' 'X' 'B' version      starts a writer session, resets the tables below
+//   Location  id line file\0 function\0    interns a source location
+//   Thread    id text                      interns a thread id
+//   Log       ts_delta level location thread message
+//   FieldsLog ts_delta level location thread fields_size fields message
+// ids, lines and lengths are LEB128 varints, ts_delta is the zigzag varint difference in
+// nanoseconds from the previous Log record of the session (from the epoch for the first).
+// fields are in the encoding of FZXLog::Fields; records without fields are written as Log.
+
+namespace FZXLog::Sink::Binary {
+
+constexpr char MAGIC[4] = {'F', 'Z', 'X', 'B'};
+constexpr uint8_t VERSION = 1;
+constexpr size_t FRAME_HEADER_SIZE = 8;
+constexpr size_t MAX_PAYLOAD_SIZE = 64 * 1024 * 1024;
+
+enum class RecordType : uint8_t {
+    Session  = 1,
+    Location = 2,
+    Thread   = 3,
+    Log       = 4,
+    FieldsLog = 5
+};
+
+inline uint32_t crc32(const void* p_data, size_t p_size) noexcept {
+    static constexpr std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    const auto* bytes = static_cast<const unsigned char*>(p_data);
+    for (size_t i = 0; i < p_size; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+inline void putU32(char* p_out, uint32_t p_value) noexcept {
+    for (int i = 0; i < 4; ++i) p_out[i] = static_cast<char>((p_value >> (8 * i)) & 0xFF);
+}
+
+inline uint32_t getU32(const char* p_in) noexcept {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(static_cast<unsigned char>(p_in[i])) << (8 * i);
+    return value;
+}
+
+inline void putVarint(std::string& p_out, uint64_t p_value) {
+    while (p_value >= 0x80) {
+        p_out.push_back(static_cast<char>((p_value & 0x7F) | 0x80));
+        p_value >>= 7;
+    }
+    p_out.push_back(static_cast<char>(p_value));
+}
+
+inline bool getVarint(const char*& p_in, const char* p_end, uint64_t& p_value) noexcept {
+    p_value = 0;
+    for (int shift = 0; shift < 64 && p_in < p_end; shift += 7) {
+        const auto byte = static_cast<unsigned char>(*p_in++);
+        p_value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+constexpr uint64_t zigzag(int64_t p_value) noexcept {
+    return (static_cast<uint64_t>(p_value) << 1) ^ static_cast<uint64_t>(p_value >> 63);
+}
+
+constexpr int64_t unzigzag(uint64_t p_value) noexcept {
+    return static_cast<int64_t>(p_value >> 1) ^ -static_cast<int64_t>(p_value & 1);
+}
+
+// Opens a frame at the end of p_out, returns its start for endFrame
+inline size_t beginFrame(std::string& p_out, RecordType p_type) {
+    const size_t start = p_out.size();
+    p_out.append(FRAME_HEADER_SIZE, '\0');
+    p_out.push_back(static_cast<char>(p_type));
+    return start;
+}
+
+// Fills in the length and checksum of the frame opened at p_start
+inline void endFrame(std::string& p_out, size_t p_start) noexcept {
+    const char* payload = p_out.data() + p_start + FRAME_HEADER_SIZE;
+    const size_t size = p_out.size() - p_start - FRAME_HEADER_SIZE;
+    putU32(p_out.data() + p_start, static_cast<uint32_t>(size));
+    putU32(p_out.data() + p_start + 4, crc32(payload, size));
+}
+
+// Decodes a binary log held in memory.
+// Frames that fail their checksum (torn writes after a crash) are skipped up to the next session.
+class Reader {
+public:
+
+    // Public types
+
+    struct Record {
+        SourceLocation m_location;
+        Level m_level;
+        std::chrono::system_clock::time_point m_timestamp;
+        std::string_view m_thread;
+        std::string_view m_message;
+        Fields m_fields;
+    };
+
+private:
+
+    // Private types
+
+    // Owns the strings a decoded call site points to
+    struct Location {
+        std::string m_file;
+        std::string m_function;
+        CallSite m_site;
+
+        Location(std::string p_file, std::string p_function, uint32_t p_line) :
+            m_file(std::move(p_file)),
+            m_function(std::move(p_function)),
+            m_site(m_file.c_str(), p_line, m_function.c_str())
+        {}
+    };
+
+    // Private members
+
+    std::string_view m_data;
+    size_t m_offset;
+    size_t m_skipped;
+    int64_t m_last_ns;
+    std::unordered_map<uint64_t, std::unique_ptr<Location>> m_locations;
+    std::unordered_map<uint64_t, std::string> m_threads;
+
+    // Reads the frame at m_offset, false if it is missing or damaged
+    bool readFrame(std::string_view& p_payload) const noexcept {
+        if (m_data.size() - m_offset < FRAME_HEADER_SIZE) return false;
+        const char* header = m_data.data() + m_offset;
+        const uint32_t size = getU32(header);
+        if (size == 0 || size > MAX_PAYLOAD_SIZE || m_data.size() - m_offset - FRAME_HEADER_SIZE < size) return false;
+        if (crc32(header + FRAME_HEADER_SIZE, size) != getU32(header + 4)) return false;
+        p_payload = std::string_view(header + FRAME_HEADER_SIZE, size);
+        return true;
+    }
+
+    // Moves m_offset to the next intact session frame, or to the end
+    void resync() noexcept {
+        const size_t from = m_offset;
+        size_t at = m_offset + 1;
+        for (;;) {
+            const size_t magic = m_data.find(std::string_view(MAGIC, sizeof(MAGIC)), at + FRAME_HEADER_SIZE + 1);
+            if (magic == std::string_view::npos) {
+                m_offset = m_data.size();
+                break;
+            }
+            at = magic - FRAME_HEADER_SIZE - 1;
+            m_offset = at;
+            std::string_view payload;
+            if (readFrame(payload) && static_cast<RecordType>(payload[0]) == RecordType::Session) break;
+            at = magic - FRAME_HEADER_SIZE;
+        }
+        m_skipped += m_offset - from;
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    explicit Reader(std::string_view p_data) noexcept :
+        m_data(p_data),
+        m_offset(0),
+        m_skipped(0),
+        m_last_ns(0)
+    {}
+
+    // Methods
+
+    // Decodes the next log record, false at the end of the data
+    bool next(Record& p_record) {
+        while (m_offset < m_data.size()) {
+            std::string_view payload;
+            if (!readFrame(payload)) {
+                resync();
+                continue;
+            }
+            m_offset += FRAME_HEADER_SIZE + payload.size();
+
+            const char* in = payload.data() + 1;
+            const char* end = payload.data() + payload.size();
+            uint64_t id = 0;
+
+            switch (static_cast<RecordType>(payload[0])) {
+                case RecordType::Session:
+                    m_locations.clear();
+                    m_threads.clear();
+                    m_last_ns = 0;
+                    break;
+
+                case RecordType::Location: {
+                    uint64_t line = 0;
+                    if (!getVarint(in, end, id) || !getVarint(in, end, line)) break;
+                    const char* file = in;
+                    const char* fileEnd = static_cast<const char*>(std::memchr(in, '\0', end - in));
+                    if (!fileEnd) break;
+                    const char* func = fileEnd + 1;
+                    const char* funcEnd = static_cast<const char*>(std::memchr(func, '\0', end - func));
+                    if (!funcEnd) break;
+                    m_locations[id] = std::make_unique<Location>(std::string(file, fileEnd), std::string(func, funcEnd), static_cast<uint32_t>(line));
+                    break;
+                }
+
+                case RecordType::Thread:
+                    if (!getVarint(in, end, id)) break;
+                    m_threads[id] = std::string(in, end);
+                    break;
+
+                case RecordType::Log:
+                case RecordType::FieldsLog: {
+                    uint64_t delta = 0, location = 0, thread = 0, fields = 0;
+                    if (!getVarint(in, end, delta) || in >= end) break;
+                    const auto level = static_cast<Level>(*in++);
+                    if (!getVarint(in, end, location) || !getVarint(in, end, thread)) break;
+                    if (static_cast<RecordType>(payload[0]) == RecordType::FieldsLog) {
+                        if (!getVarint(in, end, fields) || fields > static_cast<uint64_t>(end - in)) break;
+                        p_record.m_fields = Fields::fromData(std::string_view(in, fields));
+                        in += fields;
+                    } else {
+                        p_record.m_fields.clear();
+                    }
+
+                    m_last_ns += unzigzag(delta);
+                    p_record.m_timestamp = std::chrono::system_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(m_last_ns))
+                    );
+                    p_record.m_level = level;
+
+                    const auto loc = m_locations.find(location);
+                    p_record.m_location = loc == m_locations.end() ? SourceLocation() : SourceLocation(loc->second->m_site);
+
+                    const auto th = m_threads.find(thread);
+                    p_record.m_thread = th == m_threads.end() ? std::string_view() : std::string_view(th->second);
+                    p_record.m_message = std::string_view(in, end - in);
+                    return true;
+                }
+
+                default:
+                    break;
+            }
+        }
+        return false;
+    }
+
+    // Bytes passed over because of damaged frames
+    size_t skippedBytes() const noexcept {
+        return m_skipped;
+    }
+};
+
+} // namespace FZXLog::Sink::Binary
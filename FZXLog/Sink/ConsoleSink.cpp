@@ -1,51 +1,187 @@
 #include "ConsoleSink.h"
 #include <iostream>
 
+#if defined(_WIN32)
+#include <io.h>
+#define FZXLOG_CONSOLE_WRITE ::_write
+#define FZXLOG_CONSOLE_ISATTY ::_isatty
+#else
+#include <cerrno>
+#include <unistd.h>
+#define FZXLOG_CONSOLE_WRITE ::write
+#define FZXLOG_CONSOLE_ISATTY ::isatty
+#endif
+
 namespace FZXLog::Sink {
 
+ConsoleSink_st::ConsoleSink_st(
+    std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
+    const Level& p_minLevel,
+    const Level& p_flushLevel,
+    bool p_colored,
+    ConsoleMode p_mode,
+    const Level& p_stderr_level
+) noexcept :
+    Sink(std::move(p_formatter), p_minLevel, p_flushLevel),
+    m_mode(p_mode),
+    m_stderr_level(p_stderr_level),
+    m_color_fd{false, p_colored, p_colored},
+    m_tty_fd{false, false, false},
+    m_buffer_fd(1),
+    m_last_drain(std::chrono::system_clock::now())
+{
+    m_accepts_formatted = true;
+
+    for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+        m_prefix[i] = FZXLogLevelToAnsiCode(static_cast<Level>(i));
+    }
+
+    if (m_mode == ConsoleMode::Direct) {
+        for (int fd = 1; fd <= 2; ++fd) {
+            m_tty_fd[fd] = FZXLOG_CONSOLE_ISATTY(fd) != 0;
+            m_color_fd[fd] = p_colored && m_tty_fd[fd];
+        }
+        try {
+            m_buffer.reserve(DIRECT_BUFFER_SIZE + 1024);
+        } catch (...) {}
+    }
+}
+
+ConsoleSink_st::~ConsoleSink_st() {
+    if (m_mode == ConsoleMode::Direct) drain();
+}
+
+std::string& ConsoleSink_st::begin_line(const Level& p_level, int& p_fd) noexcept {
+    if (m_mode == ConsoleMode::Stream) {
+        p_fd = 1;
+        m_buffer.clear();
+        return m_buffer;
+    }
+
+    p_fd = static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_stderr_level) && m_stderr_level != Level::Off ? 2 : 1;
+    // Keep the order of records across the two descriptors
+    if (p_fd != m_buffer_fd) {
+        drain();
+        m_buffer_fd = p_fd;
+    }
+    return m_buffer;
+}
+
+void ConsoleSink_st::end_line(int p_fd, const std::chrono::system_clock::time_point& p_timestamp) noexcept {
+    if (m_mode == ConsoleMode::Stream) {
+        try {
+            std::cout.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            recordBytes(m_buffer.size());
+        } catch (...) {}
+        return;
+    }
+
+    // The record timestamp stands in for a clock read
+    if (m_tty_fd[p_fd] || m_buffer.size() >= DIRECT_BUFFER_SIZE || p_timestamp - m_last_drain >= DIRECT_FLUSH_INTERVAL) {
+        drain();
+    }
+}
+
+void ConsoleSink_st::drain() noexcept {
+    m_last_drain = std::chrono::system_clock::now();
+
+    const char* data = m_buffer.data();
+    size_t remaining = m_buffer.size();
+    while (remaining > 0) {
+        const auto written = FZXLOG_CONSOLE_WRITE(m_buffer_fd, data, static_cast<unsigned>(remaining));
+        if (written < 0) {
+#if !defined(_WIN32)
+            if (errno == EINTR) continue;
+#endif
+            break;
+        }
+        recordBytes(static_cast<uint64_t>(written));
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    m_buffer.clear();
+}
+
 void ConsoleSink_st::write(
     const SourceLocation& p_loc,
     const Level& p_level,
     const std::string& p_message,
     const std::chrono::system_clock::time_point& p_timestamp,
-    const std::thread::id& p_threadId
+    const std::thread::id& p_threadId,
+    const Fields& p_fields
 ) noexcept {
-    if (m_formatter) {
-        std::string formatted_message = m_formatter->format(p_loc, p_level, p_message, p_timestamp, p_threadId);
-        if (m_colored) {
+    int fd;
+    std::string& out = begin_line(p_level, fd);
+    const size_t start = out.size();
+    const bool colored = m_formatter && m_color_fd[fd] && static_cast<size_t>(p_level) < LEVEL_COUNT;
+    try {
+        if (m_formatter) {
             // Add color codes based on log level
-            switch (p_level) {
-                case Level::Trace:
-                    formatted_message = FZXLOG_ANSICODE_TRACE + formatted_message;
-                    break;
-                case Level::Debug:
-                    formatted_message = FZXLOG_ANSICODE_DEBUG + formatted_message;
-                    break;
-                case Level::Info:
-                    formatted_message = FZXLOG_ANSICODE_INFO + formatted_message;
-                    break;
-                case Level::Warning:
-                    formatted_message = FZXLOG_ANSICODE_WARNING + formatted_message;
-                    break;
-                case Level::Error:
-                    formatted_message = FZXLOG_ANSICODE_ERROR + formatted_message;
-                    break;
-                case Level::Fatal:
-                    formatted_message = FZXLOG_ANSICODE_FATAL + formatted_message;
-                    break;
-                default:
-                    break;
-            }
+            if (colored) out.append(m_prefix[static_cast<size_t>(p_level)]);
+            m_formatter->format_to(out, p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+            if (colored) out.append(FZXLOG_ANSICODE_RESET);
+        } else {
+            out.append(p_message);
         }
-        formatted_message += FZXLOG_ANSICODE_RESET;
-        std::cout << formatted_message << '\n';
-    } else {
-        std::cout << p_message << '\n';
+        out.push_back('\n');
+    } catch (...) {
+        out.resize(start);
+        return;
     }
+    end_line(fd, p_timestamp);
+}
+
+void ConsoleSink_st::writeFormatted(
+    const Level& p_level,
+    std::string_view p_line,
+    const std::chrono::system_clock::time_point& p_timestamp
+) noexcept {
+    int fd;
+    std::string& out = begin_line(p_level, fd);
+    const size_t start = out.size();
+    const bool colored = m_color_fd[fd] && static_cast<size_t>(p_level) < LEVEL_COUNT;
+    try {
+        if (colored) out.append(m_prefix[static_cast<size_t>(p_level)]);
+        out.append(p_line);
+        if (colored) out.append(FZXLOG_ANSICODE_RESET);
+        out.push_back('\n');
+    } catch (...) {
+        out.resize(start);
+        return;
+    }
+    end_line(fd, p_timestamp);
 }
 
 void ConsoleSink_st::flush() noexcept {
-    std::cout.flush();
+    if (m_mode == ConsoleMode::Direct) {
+        drain();
+        return;
+    }
+    try {
+        std::cout.flush();
+    } catch (...) {}
+}
+
+void ConsoleSink_st::spillEmergency() noexcept {
+    if (m_mode == ConsoleMode::Direct && !m_buffer.empty()) drain();
+}
+
+bool ConsoleSink_st::writeEmergency(const Level& p_level, std::string_view p_line) noexcept {
+    const int fd = static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_stderr_level) && m_stderr_level != Level::Off ? 2 : 1;
+    const char newline = '\n';
+    for (std::string_view part : {p_line, std::string_view(&newline, 1)}) {
+        while (!part.empty()) {
+            const auto written = FZXLOG_CONSOLE_WRITE(fd, part.data(), static_cast<unsigned>(part.size()));
+            if (written < 0) {
+#if !defined(_WIN32)
+                if (errno == EINTR) continue;
+#endif
+                return false;
+            }
+            part.remove_prefix(static_cast<size_t>(written));
+        }
+    }
+    return true;
 }
 
 } // namespace FZXLog::Sink
@@ -2,7 +2,10 @@
 
 #include "Sink.h"
 
+#include <array>
+#include <chrono>
 #include <mutex>
+#include <string_view>
 
 // Color Configuration
 
@@ -35,12 +38,40 @@ static inline const char* FZXLogLevelToAnsiCode(Level p_level) {
 
 namespace FZXLog::Sink {
 
+// Where ConsoleSink writes
+enum class ConsoleMode : uint8_t {
+    Stream, // std::cout
+    Direct  // write(2) on stdout or stderr from the sink's own buffer
+};
+
 class ConsoleSink_st : public Sink {
 private:
 
     // Private members
 
-    bool m_colored;
+    static constexpr size_t DIRECT_BUFFER_SIZE = 64 * 1024;
+    static constexpr std::chrono::milliseconds DIRECT_FLUSH_INTERVAL{1000};
+
+    ConsoleMode m_mode;
+    Level m_stderr_level;
+    std::array<std::string_view, LEVEL_COUNT> m_prefix; // Color codes, looked up once
+
+    // Per descriptor (index 1 stdout, 2 stderr) in Direct mode: colors only on a terminal,
+    // and terminals get each record at once instead of when the buffer fills
+    bool m_color_fd[3];
+    bool m_tty_fd[3];
+
+    // Stream: the current line. Direct: bytes not yet written to m_buffer_fd
+    std::string m_buffer;
+    int m_buffer_fd;
+    std::chrono::system_clock::time_point m_last_drain;
+
+    // Buffer for a record at p_level, the descriptor it goes to is stored in p_fd
+    std::string& begin_line(const Level& p_level, int& p_fd) noexcept;
+    // Writes out the line just appended to m_buffer, or leaves it buffered
+    void end_line(int p_fd, const std::chrono::system_clock::time_point& p_timestamp) noexcept;
+    // Direct mode: writes the pending bytes
+    void drain() noexcept;
 
 protected:
 
@@ -50,32 +81,47 @@ protected:
         const SourceLocation& p_loc,
         const Level& p_level,
         const std::string& p_message,
-        const std::chrono::system_clock::time_point& p_timestamp = std::chrono::system_clock::now(),
-        const std::thread::id& p_threadId = std::this_thread::get_id()
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override;
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
     ) noexcept override;
 
 public:
 
     // Constructor/Destructor
 
+    // Direct mode skips iostreams: lines are collected in a 64 KiB buffer and written with
+    // write(2) when it fills, on flush(), or when a record arrives more than a second after
+    // the last write. There is no timer, so a quiet process keeps up to 64 KiB until a
+    // flush; set Logger::FlushPolicy::m_interval for that. Output to a terminal is written
+    // per record and only it is colored. Records at p_stderr_level or above go to stderr
+    // (Off keeps everything on stdout). Stream mode writes to std::cout as before.
     ConsoleSink_st(
         std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
         const Level& p_minLevel = Level::Trace,
         const Level& p_flushLevel = Level::Error,
-        bool p_colored = true
-    ) noexcept :
-        m_colored(p_colored),
-        Sink(
-            p_formatter,
-            p_minLevel,
-            p_flushLevel
-        )
-    {}
-    virtual ~ConsoleSink_st() = default;
+        bool p_colored = true,
+        ConsoleMode p_mode = ConsoleMode::Stream,
+        const Level& p_stderr_level = Level::Off
+    ) noexcept;
+    virtual ~ConsoleSink_st() override;
 
     // Methods
 
     virtual void flush() noexcept override;
+
+    // Direct mode drains its buffer; Stream mode leaves std::cout alone, its buffer is lost
+    virtual void spillEmergency() noexcept override;
+    virtual bool writeEmergency(const Level& p_level, std::string_view p_line) noexcept override;
+
+    ConsoleMode getMode() const noexcept {
+        return m_mode;
+    }
 };
 
 class ConsoleSink_mt : public ConsoleSink_st {
@@ -93,11 +139,20 @@ protected:
         const SourceLocation& p_loc,
         const Level& p_level,
         const std::string& p_message,
-        const std::chrono::system_clock::time_point& p_timestamp = std::chrono::system_clock::now(),
-        const std::thread::id& p_threadId = std::this_thread::get_id()
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ConsoleSink_st::write(p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+    }
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
     ) noexcept override {
         std::lock_guard<std::mutex> lock(m_mutex);
-        ConsoleSink_st::write(p_loc, p_level, p_message, p_timestamp, p_threadId);
+        ConsoleSink_st::writeFormatted(p_level, p_line, p_timestamp);
     }
 
 public:
@@ -108,13 +163,17 @@ public:
         std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
         const Level& p_minLevel = Level::Trace,
         const Level& p_flushLevel = Level::Error,
-        bool p_colored = true
+        bool p_colored = true,
+        ConsoleMode p_mode = ConsoleMode::Stream,
+        const Level& p_stderr_level = Level::Off
     ) noexcept :
         ConsoleSink_st(
             p_formatter,
             p_minLevel,
             p_flushLevel,
-            p_colored
+            p_colored,
+            p_mode,
+            p_stderr_level
         )
     {}
     virtual ~ConsoleSink_mt() = default;
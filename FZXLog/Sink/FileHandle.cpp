@@ -0,0 +1,67 @@
+#include "FileHandle.h"
+
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace FZXLog::Sink {
+
+bool FileHandle::open(const std::string& p_path) noexcept {
+    close();
+#if defined(_WIN32)
+    m_fd = ::_open(p_path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    m_fd = ::open(p_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+    return m_fd >= 0;
+}
+
+void FileHandle::close() noexcept {
+    if (m_fd < 0) return;
+#if defined(_WIN32)
+    ::_close(m_fd);
+#else
+    ::close(m_fd);
+#endif
+    m_fd = -1;
+}
+
+bool FileHandle::write(const char* p_data, size_t p_size) noexcept {
+    if (m_fd < 0) return false;
+
+    while (p_size > 0) {
+#if defined(_WIN32)
+        const unsigned int chunk = p_size > 0x40000000u ? 0x40000000u : static_cast<unsigned int>(p_size);
+        const int written = ::_write(m_fd, p_data, chunk);
+#else
+        const ssize_t written = ::write(m_fd, p_data, p_size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p_data += written;
+        p_size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void FileHandle::sync() noexcept {
+    if (m_fd < 0) return;
+#if defined(_WIN32)
+    ::_commit(m_fd);
+#elif defined(__APPLE__)
+    ::fsync(m_fd);
+#else
+    ::fdatasync(m_fd);
+#endif
+}
+
+} // namespace FZXLog::Sink
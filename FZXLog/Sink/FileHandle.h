@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+namespace FZXLog::Sink {
+
+// When file data is forced to stable storage
+enum class SyncPolicy : uint8_t {
+    None     = 0,   // Leave it to the OS
+    OnFlush  = 1,   // fdatasync on every flush()
+    Interval = 2    // fdatasync each time the flush interval elapses
+};
+
+// Minimal append-only file on top of the OS descriptor API
+class FileHandle {
+private:
+
+    // Private members
+
+    int m_fd;
+
+public:
+
+    // Constructor/Destructor
+
+    FileHandle() noexcept : m_fd(-1) {}
+    ~FileHandle() noexcept { close(); }
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    // Methods
+
+    // Opens p_path for appending, creating it if needed
+    bool open(const std::string& p_path) noexcept;
+    void close() noexcept;
+
+    bool is_open() const noexcept {
+        return m_fd >= 0;
+    }
+    int native() const noexcept {
+        return m_fd;
+    }
+
+    // Writes the whole range, retrying short writes; false on error
+    bool write(const char* p_data, size_t p_size) noexcept;
+
+    // Forces written data to stable storage
+    void sync() noexcept;
+};
+
+} // namespace FZXLog::Sink
@@ -0,0 +1,232 @@
+#include "MmapFileSink.h"
+
+#if !defined(_WIN32)
+
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FZXLog::Sink {
+
+MmapFileSink::MmapFileSink(
+    const std::string& p_base_filename,
+    std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
+    const Level& p_level,
+    const Level& p_flush_level,
+    size_t p_segment_size
+) noexcept :
+    Sink(std::move(p_formatter), p_level, p_flush_level),
+    m_base_filename(p_base_filename),
+    m_segment_size(p_segment_size > 4096 ? p_segment_size : 4096),
+    m_next_file_index(0),
+    m_current(nullptr)
+{
+    m_accepts_formatted = true;
+    try {
+        std::filesystem::path basePath(m_base_filename);
+        if (!basePath.parent_path().empty()) {
+            std::filesystem::create_directories(basePath.parent_path());
+        }
+    } catch (...) {}
+
+    if (open_segment(m_segments[0])) {
+        m_current.store(&m_segments[0], std::memory_order_release);
+    }
+}
+
+MmapFileSink::~MmapFileSink() {
+    std::lock_guard<std::mutex> lock(m_rotate_mutex);
+    Segment* segment = m_current.exchange(nullptr);
+    if (segment) {
+        while (segment->m_writers.load() != 0) std::this_thread::yield();
+        close_segment(*segment, segment->m_cursor.load(std::memory_order_relaxed));
+    }
+}
+
+bool MmapFileSink::open_segment(Segment& p_segment) noexcept {
+    // Skip over segments that are already full (preallocated by an earlier run)
+    for (;;) {
+        const std::string filename = m_base_filename + "." + std::to_string(m_next_file_index++);
+
+        const int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        const size_t used = static_cast<size_t>(st.st_size);
+        if (used >= m_segment_size) {
+            ::close(fd);
+            continue;
+        }
+
+#if defined(__linux__)
+        const bool allocated = ::posix_fallocate(fd, 0, static_cast<off_t>(m_segment_size)) == 0 ||
+            ::ftruncate(fd, static_cast<off_t>(m_segment_size)) == 0;
+#else
+        const bool allocated = ::ftruncate(fd, static_cast<off_t>(m_segment_size)) == 0;
+#endif
+        if (!allocated) {
+            ::close(fd);
+            return false;
+        }
+
+        void* data = ::mmap(nullptr, m_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            ::ftruncate(fd, static_cast<off_t>(used));
+            ::close(fd);
+            return false;
+        }
+
+        p_segment.m_data = static_cast<char*>(data);
+        p_segment.m_size = m_segment_size;
+        p_segment.m_fd = fd;
+        p_segment.m_cursor.store(used, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+void MmapFileSink::close_segment(Segment& p_segment, size_t p_used) noexcept {
+    if (!p_segment.m_data) return;
+
+    ::munmap(p_segment.m_data, p_segment.m_size);
+    ::ftruncate(p_segment.m_fd, static_cast<off_t>(p_used < p_segment.m_size ? p_used : p_segment.m_size));
+    ::close(p_segment.m_fd);
+
+    p_segment.m_data = nullptr;
+    p_segment.m_fd = -1;
+}
+
+MmapFileSink::Segment* MmapFileSink::acquire_segment() noexcept {
+    for (;;) {
+        Segment* segment = m_current.load();
+        if (!segment) return nullptr;
+
+        segment->m_writers.fetch_add(1);
+        if (m_current.load() == segment) return segment;
+        segment->m_writers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void MmapFileSink::rotate(Segment* p_full, size_t p_used) noexcept {
+    std::lock_guard<std::mutex> lock(m_rotate_mutex);
+    if (m_current.load() != p_full) return;
+
+    Segment* next = (p_full == &m_segments[0]) ? &m_segments[1] : &m_segments[0];
+
+    // Stale writers may still be backing out of the retired slot
+    while (next->m_writers.load() != 0) std::this_thread::yield();
+
+    const bool opened = open_segment(*next);
+    m_current.store(opened ? next : nullptr);
+    recordRotation();
+
+    while (p_full->m_writers.load() != 0) std::this_thread::yield();
+    close_segment(*p_full, p_used);
+}
+
+void MmapFileSink::write(
+    const SourceLocation& p_loc,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_threadId,
+    const Fields& p_fields
+) noexcept {
+    thread_local std::string buffer;
+
+    try {
+        buffer.clear();
+        if (m_formatter) {
+            m_formatter->format_to(buffer, p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+        } else {
+            buffer.append(p_message);
+        }
+    } catch (...) {
+        return;
+    }
+    store(buffer);
+}
+
+void MmapFileSink::writeFormatted(
+    const Level&,
+    std::string_view p_line,
+    const std::chrono::system_clock::time_point&
+) noexcept {
+    store(p_line);
+}
+
+void MmapFileSink::store(std::string_view p_line) noexcept {
+    // Lines longer than a segment are cut to fit
+    const size_t length = p_line.size() < m_segment_size ? p_line.size() : m_segment_size - 1;
+    const size_t size = length + 1;
+
+    for (;;) {
+        Segment* segment = acquire_segment();
+        if (!segment) return;
+
+        const size_t capacity = segment->m_size;
+        const size_t offset = segment->m_cursor.fetch_add(size, std::memory_order_relaxed);
+        if (offset + size <= capacity) {
+            std::memcpy(segment->m_data + offset, p_line.data(), length);
+            segment->m_data[offset + length] = '\n';
+            segment->m_writers.fetch_sub(1, std::memory_order_release);
+            recordBytes(size);
+            return;
+        }
+        segment->m_writers.fetch_sub(1, std::memory_order_release);
+
+        if (offset <= capacity) {
+            // First writer past the end: everything before offset is in use
+            rotate(segment, offset);
+        } else {
+            while (m_current.load() == segment) std::this_thread::yield();
+        }
+    }
+}
+
+bool MmapFileSink::writeEmergency(const Level&, std::string_view p_line) noexcept {
+    Segment* segment = acquire_segment();
+    if (!segment) return false;
+
+    // Reserve only if the line fits, so the cursor never moves past the end here
+    const size_t size = p_line.size() + 1;
+    size_t offset = segment->m_cursor.load(std::memory_order_relaxed);
+    bool fits = false;
+    while (offset + size <= segment->m_size) {
+        if (segment->m_cursor.compare_exchange_weak(offset, offset + size, std::memory_order_relaxed)) {
+            fits = true;
+            break;
+        }
+    }
+    if (fits) {
+        std::memcpy(segment->m_data + offset, p_line.data(), p_line.size());
+        segment->m_data[offset + p_line.size()] = '\n';
+    }
+    segment->m_writers.fetch_sub(1, std::memory_order_release);
+    return fits;
+}
+
+void MmapFileSink::flush() noexcept {
+    Segment* segment = acquire_segment();
+    if (!segment) return;
+
+    const size_t cursor = segment->m_cursor.load(std::memory_order_relaxed);
+    const size_t used = cursor < segment->m_size ? cursor : segment->m_size;
+    if (used > 0) {
+        ::msync(segment->m_data, used, MS_ASYNC);
+    }
+    segment->m_writers.fetch_sub(1, std::memory_order_release);
+}
+
+} // namespace FZXLog::Sink
+
+#endif // !_WIN32
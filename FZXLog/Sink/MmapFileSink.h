@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Sink.h"
+
+#if !defined(_WIN32)
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace FZXLog::Sink {
+
+// Rotating file sink writing into memory-mapped, preallocated segments.
+// Writers reserve space with an atomic cursor and copy the formatted line into the
+// mapping, so concurrent writers never take a sink-wide lock; only the writer that
+// crosses the end of a segment rotates to the next file (base.N).
+// Segments are truncated to their used size when closed. After a crash the last
+// segment keeps its zero-filled tail.
+class MmapFileSink : public Sink {
+private:
+
+    // Private types
+
+    struct Segment {
+        char* m_data = nullptr;
+        size_t m_size = 0;
+        int m_fd = -1;
+        std::atomic<size_t> m_cursor{0};
+        std::atomic<size_t> m_writers{0};
+    };
+
+    // Private members
+
+    std::string m_base_filename;
+    size_t m_segment_size;
+    size_t m_next_file_index;
+
+    // Two segment slots are reused alternately, a retired slot is only
+    // reopened once all of its writers are gone
+    Segment m_segments[2];
+    std::atomic<Segment*> m_current;
+    std::mutex m_rotate_mutex;
+
+    bool open_segment(Segment& p_segment) noexcept;
+    void close_segment(Segment& p_segment, size_t p_used) noexcept;
+    void rotate(Segment* p_full, size_t p_used) noexcept;
+
+    // Pins the current segment, returns nullptr if no segment is open
+    Segment* acquire_segment() noexcept;
+    // Copies p_line and a newline into the current segment
+    void store(std::string_view p_line) noexcept;
+
+protected:
+
+    // Methods
+
+    virtual void write(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override;
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
+    ) noexcept override;
+
+public:
+
+    // Constructor/Destructor
+
+    MmapFileSink(
+        const std::string& p_base_filename,
+        std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
+        const Level& p_level = Level::Trace,
+        const Level& p_flush_level = Level::Error,
+        size_t p_segment_size = 16 * 1024 * 1024 // 16 MB
+    ) noexcept;
+    virtual ~MmapFileSink() override;
+
+    MmapFileSink(const MmapFileSink&) = delete;
+    MmapFileSink& operator=(const MmapFileSink&) = delete;
+
+    // Methods
+
+    // Schedules write-back of the mapped pages
+    virtual void flush() noexcept override;
+
+    // The mapping survives the process, only writeEmergency() has work to do. It gives up
+    // instead of rotating when the segment is full.
+    virtual bool writeEmergency(const Level& p_level, std::string_view p_line) noexcept override;
+};
+
+} // namespace FZXLog::Sink
+
+#endif // !_WIN32
@@ -8,21 +8,62 @@ RotationFileSink_st::RotationFileSink_st(
     std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
     const Level& p_level,
     const Level& p_flush_level,
-    size_t p_max_file_size
+    size_t p_max_file_size,
+    size_t p_buffer_size,
+    std::chrono::milliseconds p_flush_interval,
+    SyncPolicy p_sync_policy,
+    Compression p_compression,
+    const RetentionPolicy& p_retention
 ) noexcept :
+    Sink(std::move(p_formatter), p_level, p_flush_level),
     m_base_filename(p_base_filename),
     m_max_file_size(p_max_file_size),
     m_current_file_index(0),
-    Sink(std::move(p_formatter), p_level, p_flush_level)
+    m_buffer_size(p_buffer_size),
+    m_file_size(0),
+    m_flush_interval(p_flush_interval),
+    m_last_drain(std::chrono::system_clock::now()),
+    m_sync_policy(p_sync_policy)
 {
+    m_accepts_formatted = true;
+    try {
+        m_buffer.reserve(m_buffer_size + 1024);
+    } catch (...) {}
+
+    // Resume the newest segment, or start after it if it was already compressed
+    std::vector<SegmentArchiver::Segment> existing;
+    try {
+        existing = SegmentArchiver::listSegments(m_base_filename);
+    } catch (...) {}
+    if (!existing.empty()) {
+        m_current_file_index = existing.back().m_index + (existing.back().m_compressed ? 1 : 0);
+    }
+
+    if (p_compression != Compression::None || p_retention.enabled()) {
+        try {
+            m_archiver = std::make_unique<SegmentArchiver>(m_base_filename, p_compression, p_retention);
+        } catch (...) {}
+    }
+
+    // Segments left uncompressed by an earlier run
+    if (m_archiver) {
+        for (const auto& segment : existing) {
+            if (segment.m_index < m_current_file_index && !segment.m_compressed) {
+                m_archiver->submit(segment.m_index, m_current_file_index);
+            }
+        }
+    }
+
     open_current_file();
 }
 
 RotationFileSink_st::~RotationFileSink_st() noexcept {
     if (m_current_file.is_open()) {
-        m_current_file.flush();
+        drain();
+        if (m_sync_policy != SyncPolicy::None) m_current_file.sync();
         m_current_file.close();
     }
+    m_archiver.reset();
 }
 
 void RotationFileSink_st::write(
@@ -30,52 +71,104 @@ void RotationFileSink_st::write(
     const Level& p_level,
     const std::string& p_message,
     const std::chrono::system_clock::time_point& p_timestamp,
-    const std::thread::id& p_threadId
+    const std::thread::id& p_threadId,
+    const Fields& p_fields
 ) noexcept {
     if (!m_current_file.is_open()) {
         return;
     }
 
+    const size_t before = m_buffer.size();
     try {
         if (m_formatter) {
-            m_current_file
-                << m_formatter->format(
-                    p_loc,
-                    p_level,
-                    p_message,
-                    p_timestamp,
-                    p_threadId
-                )
-                << '\n';
+            m_formatter->format_to(m_buffer, p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
         }
         else {
-            m_current_file << p_message << '\n';
+            m_buffer.append(p_message);
         }
+        m_buffer.push_back('\n');
+    } catch (...) {
+        m_buffer.resize(before);
+        return;
+    }
+    commit(before, p_timestamp);
+}
+
+void RotationFileSink_st::writeFormatted(
+    const Level&,
+    std::string_view p_line,
+    const std::chrono::system_clock::time_point& p_timestamp
+) noexcept {
+    if (!m_current_file.is_open()) {
+        return;
+    }
+
+    const size_t before = m_buffer.size();
+    try {
+        m_buffer.append(p_line);
+        m_buffer.push_back('\n');
     } catch (...) {
+        m_buffer.resize(before);
         return;
     }
+    commit(before, p_timestamp);
+}
 
-    const std::streampos pos = m_current_file.tellp();
+void RotationFileSink_st::commit(size_t p_before, const std::chrono::system_clock::time_point& p_timestamp) noexcept {
+    m_file_size += m_buffer.size() - p_before;
 
-    if (pos != static_cast<std::streampos>(-1) &&
-        static_cast<size_t>(pos) >= m_max_file_size) {
+    if (m_buffer.size() >= m_buffer_size) {
+        drain();
+    }
+    // The record timestamp stands in for a clock read
+    else if (m_flush_interval.count() > 0 && p_timestamp - m_last_drain >= m_flush_interval) {
+        drain();
+        if (m_sync_policy == SyncPolicy::Interval) m_current_file.sync();
+    }
+
+    if (m_file_size >= m_max_file_size) {
         rotate_file();
     }
 }
 
+void RotationFileSink_st::drain() noexcept {
+    m_last_drain = std::chrono::system_clock::now();
+    if (m_buffer.empty()) return;
+
+    if (m_current_file.write(m_buffer.data(), m_buffer.size())) {
+        recordBytes(m_buffer.size());
+    }
+    m_buffer.clear();
+}
+
 void RotationFileSink_st::flush() noexcept {
     if (m_current_file.is_open()) {
-        m_current_file.flush();
+        drain();
+        if (m_sync_policy == SyncPolicy::OnFlush) m_current_file.sync();
     }
 }
 
+void RotationFileSink_st::spillEmergency() noexcept {
+    if (m_current_file.is_open()) drain();
+}
+
+bool RotationFileSink_st::writeEmergency(const Level&, std::string_view p_line) noexcept {
+    return m_current_file.write(p_line.data(), p_line.size()) && m_current_file.write("\n", 1);
+}
+
 void RotationFileSink_st::rotate_file() noexcept {
-    m_current_file.flush();
+    drain();
+    if (m_sync_policy != SyncPolicy::None) m_current_file.sync();
     m_current_file.close();
 
     ++m_current_file_index;
+    recordRotation();
 
     open_current_file();
+
+    if (m_archiver) {
+        m_archiver->submit(m_current_file_index - 1, m_current_file_index);
+    }
 }
 
 void RotationFileSink_st::open_current_file() noexcept {
@@ -90,11 +183,15 @@ void RotationFileSink_st::open_current_file() noexcept {
         std::filesystem::path filename =
             basePath.string() + "." + std::to_string(m_current_file_index);
 
-        m_current_file.open(filename, std::ios::out | std::ios::app);
+        m_current_file.open(filename.string());
+
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(filename, ec);
+        m_file_size = ec ? 0 : static_cast<size_t>(size);
     }
     catch (...) {
         return;
     }
 }
 
-} // namespace FZXLog::Sink
\ No newline at end of file
+} // namespace FZXLog::Sink
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Sink.h"
+#include "FileHandle.h"
+#include "SegmentArchiver.h"
 
+#include <chrono>
 #include <mutex>
-#include <fstream>
 
 #define FZXLOG_ROTATION_FILE_NAME_FMT "%s.%zu" // base_filename.index
 
@@ -17,10 +19,25 @@ private:
     std::string m_base_filename;
     size_t m_max_file_size;
     size_t m_current_file_index;
-    std::ofstream m_current_file;
+    FileHandle m_current_file;
+
+    // Write coalescing: records accumulate in m_buffer and reach the file in one
+    // write() when it fills up, when the flush interval elapses, or on flush()
+    std::string m_buffer;
+    size_t m_buffer_size;
+    size_t m_file_size; // Bytes in the current file, including the buffered ones
+    std::chrono::milliseconds m_flush_interval;
+    std::chrono::system_clock::time_point m_last_drain;
+    SyncPolicy m_sync_policy;
+
+    // Compresses and prunes rotated files in the background, null when neither is configured
+    std::unique_ptr<SegmentArchiver> m_archiver;
 
     void open_current_file() noexcept;
     void rotate_file() noexcept;
+    void drain() noexcept;
+    // Accounts the line appended to m_buffer after p_before, then drains or rotates as needed
+    void commit(size_t p_before, const std::chrono::system_clock::time_point& p_timestamp) noexcept;
 
 protected:
 
@@ -30,8 +47,14 @@ protected:
         const SourceLocation& p_loc,
         const Level& p_level,
         const std::string& p_message,
-        const std::chrono::system_clock::time_point& p_timestamp = std::chrono::system_clock::now(),
-        const std::thread::id& p_threadId = std::this_thread::get_id()
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override;
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
     ) noexcept override;
 
 public:
@@ -43,13 +66,27 @@ public:
         std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
         const Level& p_level = Level::Trace,
         const Level& p_flush_level = Level::Error,
-        size_t p_max_file_size = 10 * 1024 * 1024 // 10 MB
+        size_t p_max_file_size = 10 * 1024 * 1024, // 10 MB
+        size_t p_buffer_size = 256 * 1024, // 256 KiB
+        std::chrono::milliseconds p_flush_interval = std::chrono::milliseconds(1000),
+        SyncPolicy p_sync_policy = SyncPolicy::None,
+        Compression p_compression = Compression::None,
+        const RetentionPolicy& p_retention = RetentionPolicy()
     ) noexcept;
     virtual ~RotationFileSink_st() override;
 
     // Methods
 
     virtual void flush() noexcept override;
+
+    virtual void spillEmergency() noexcept override;
+    virtual bool writeEmergency(const Level& p_level, std::string_view p_line) noexcept override;
+
+    // The compression applied to rotated files. None when Gzip was asked for in a build
+    // without zlib, or when the archiver thread could not be started.
+    Compression getCompression() const noexcept {
+        return m_archiver ? m_archiver->getCompression() : Compression::None;
+    }
 };
 
 class RotationFileSink_mt : public RotationFileSink_st {
@@ -67,11 +104,20 @@ protected:
         const SourceLocation& p_loc,
         const Level& p_level,
         const std::string& p_message,
-        const std::chrono::system_clock::time_point& p_timestamp = std::chrono::system_clock::now(),
-        const std::thread::id& p_threadId = std::this_thread::get_id()
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        RotationFileSink_st::write(p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+    }
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
     ) noexcept override {
         std::lock_guard<std::mutex> lock(m_mutex);
-        RotationFileSink_st::write(p_loc, p_level, p_message, p_timestamp, p_threadId);
+        RotationFileSink_st::writeFormatted(p_level, p_line, p_timestamp);
     }
 
 public:
@@ -83,14 +129,24 @@ public:
         std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
         const Level& p_level = Level::Trace,
         const Level& p_flush_level = Level::Error,
-        size_t p_max_file_size = 10 * 1024 * 1024 // 10 MB
+        size_t p_max_file_size = 10 * 1024 * 1024, // 10 MB
+        size_t p_buffer_size = 256 * 1024, // 256 KiB
+        std::chrono::milliseconds p_flush_interval = std::chrono::milliseconds(1000),
+        SyncPolicy p_sync_policy = SyncPolicy::None,
+        Compression p_compression = Compression::None,
+        const RetentionPolicy& p_retention = RetentionPolicy()
     ) noexcept :
         RotationFileSink_st(
             p_base_filename,
             std::move(p_formatter),
             p_level,
             p_flush_level,
-            p_max_file_size
+            p_max_file_size,
+            p_buffer_size,
+            p_flush_interval,
+            p_sync_policy,
+            p_compression,
+            p_retention
         )
     {}
     virtual ~RotationFileSink_mt() override = default;
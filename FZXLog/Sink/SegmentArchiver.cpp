@@ -0,0 +1,226 @@
+#include "SegmentArchiver.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#if defined(FZXLOG_HAS_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace FZXLog::Sink {
+
+SegmentArchiver::SegmentArchiver(const std::string& p_base_filename, Compression p_compression, const RetentionPolicy& p_retention) :
+    m_base_filename(p_base_filename),
+    m_compression(isSupported(p_compression) ? p_compression : Compression::None),
+    m_retention(p_retention),
+    m_active_index(0),
+    m_stop(false)
+{
+    m_worker = std::thread(&SegmentArchiver::run, this);
+}
+
+SegmentArchiver::~SegmentArchiver() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    if (m_worker.joinable()) m_worker.join();
+}
+
+bool SegmentArchiver::isSupported(Compression p_compression) noexcept {
+#if defined(FZXLOG_HAS_ZLIB)
+    return p_compression == Compression::None || p_compression == Compression::Gzip;
+#else
+    return p_compression == Compression::None;
+#endif
+}
+
+void SegmentArchiver::submit(size_t p_index, size_t p_active_index) noexcept {
+    try {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(p_index);
+        if (p_active_index > m_active_index.load(std::memory_order_relaxed)) {
+            m_active_index.store(p_active_index, std::memory_order_relaxed);
+        }
+    } catch (...) {
+        return;
+    }
+    m_cv.notify_one();
+}
+
+void SegmentArchiver::run() {
+    removeStaleTemps();
+
+    std::deque<size_t> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+            if (m_pending.empty()) return; // Stopped with nothing left
+            batch.swap(m_pending);
+        }
+
+        for (size_t index : batch) {
+            compress(index);
+        }
+        batch.clear();
+
+        if (m_retention.enabled()) {
+            applyRetention();
+        }
+    }
+}
+
+void SegmentArchiver::compress(size_t p_index) noexcept {
+    if (m_compression == Compression::None) return;
+
+#if defined(FZXLOG_HAS_ZLIB)
+    const std::string source = m_base_filename + "." + std::to_string(p_index);
+    const std::string target = source + ".gz";
+    const std::string temp = target + ".tmp";
+
+    std::FILE* in = std::fopen(source.c_str(), "rb");
+    if (!in) return;
+
+    // Level 1: the archiver should keep up with rotation, not win on ratio
+    gzFile out = gzopen(temp.c_str(), "wb1");
+    if (!out) {
+        std::fclose(in);
+        return;
+    }
+
+    char chunk[64 * 1024];
+    bool ok = true;
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        if (gzwrite(out, chunk, static_cast<unsigned>(read)) != static_cast<int>(read)) {
+            ok = false;
+            break;
+        }
+    }
+    ok = ok && !std::ferror(in);
+    std::fclose(in);
+    ok = (gzclose(out) == Z_OK) && ok;
+
+    std::error_code ec;
+    if (!ok) {
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+    std::filesystem::rename(temp, target, ec);
+    if (!ec) {
+        std::filesystem::remove(source, ec);
+    }
+#else
+    (void)p_index;
+#endif
+}
+
+void SegmentArchiver::removeStaleTemps() noexcept {
+    try {
+        const std::filesystem::path basePath(m_base_filename);
+        std::filesystem::path directory = basePath.parent_path();
+        if (directory.empty()) directory = ".";
+        const std::string prefix = basePath.filename().string() + ".";
+
+        std::error_code ec;
+        std::vector<std::filesystem::path> stale;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.size() <= prefix.size() + 7 || !name.starts_with(prefix) || !name.ends_with(".gz.tmp")) continue;
+
+            // base.N.gz.tmp only
+            const std::string_view digits = std::string_view(name).substr(prefix.size(), name.size() - prefix.size() - 7);
+            if (digits.empty() || digits.find_first_not_of("0123456789") != std::string_view::npos) continue;
+            stale.push_back(entry.path());
+        }
+        for (const auto& path : stale) {
+            std::filesystem::remove(path, ec);
+        }
+    } catch (...) {}
+}
+
+void SegmentArchiver::applyRetention() noexcept {
+    try {
+        std::vector<Segment> segments = listSegments(m_base_filename);
+        const size_t active = m_active_index.load(std::memory_order_relaxed);
+        segments.erase(
+            std::remove_if(segments.begin(), segments.end(), [&](const Segment& p_segment) {
+                return p_segment.m_index >= active;
+            }),
+            segments.end()
+        );
+
+        struct Entry {
+            const Segment* m_segment;
+            uint64_t m_size;
+            std::filesystem::file_time_type m_time;
+        };
+        std::vector<Entry> entries;
+        entries.reserve(segments.size());
+        uint64_t totalBytes = 0;
+        for (const Segment& segment : segments) {
+            std::error_code ec;
+            const uint64_t size = std::filesystem::file_size(segment.m_path, ec);
+            const auto time = std::filesystem::last_write_time(segment.m_path, ec);
+            entries.push_back({&segment, ec ? 0 : size, time});
+            totalBytes += ec ? 0 : size;
+        }
+
+        const auto now = std::filesystem::file_time_type::clock::now();
+        size_t remaining = entries.size();
+
+        // Oldest first: drop while any limit is exceeded
+        for (const Entry& entry : entries) {
+            const bool tooMany = m_retention.m_max_files != 0 && remaining > m_retention.m_max_files;
+            const bool tooBig = m_retention.m_max_total_bytes != 0 && totalBytes > m_retention.m_max_total_bytes;
+            const bool tooOld = m_retention.m_max_age.count() != 0 && now - entry.m_time > m_retention.m_max_age;
+            if (!tooMany && !tooBig && !tooOld) continue;
+
+            std::error_code ec;
+            if (std::filesystem::remove(entry.m_segment->m_path, ec)) {
+                --remaining;
+                totalBytes -= entry.m_size;
+            }
+        }
+    } catch (...) {}
+}
+
+std::vector<SegmentArchiver::Segment> SegmentArchiver::listSegments(const std::string& p_base_filename) {
+    std::vector<Segment> segments;
+
+    const std::filesystem::path basePath(p_base_filename);
+    std::filesystem::path directory = basePath.parent_path();
+    if (directory.empty()) directory = ".";
+    const std::string prefix = basePath.filename().string() + ".";
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (!name.starts_with(prefix)) continue;
+
+        std::string_view rest(name);
+        rest.remove_prefix(prefix.size());
+        size_t digits = 0;
+        while (digits < rest.size() && rest[digits] >= '0' && rest[digits] <= '9') ++digits;
+        if (digits == 0) continue;
+
+        const std::string_view suffix = rest.substr(digits);
+        if (!suffix.empty() && suffix != ".gz") continue;
+
+        segments.push_back({
+            static_cast<size_t>(std::stoull(std::string(rest.substr(0, digits)))),
+            (basePath.parent_path() / name).string(),
+            suffix == ".gz"
+        });
+    }
+
+    std::sort(segments.begin(), segments.end(), [](const Segment& p_a, const Segment& p_b) {
+        return p_a.m_index < p_b.m_index;
+    });
+    return segments;
+}
+
+} // namespace FZXLog::Sink
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace FZXLog::Sink {
+
+// Compression applied to rotated segments
+enum class Compression : uint8_t {
+    None = 0,
+    Gzip = 1    // base.N -> base.N.gz, needs zlib (FZXLOG_HAS_ZLIB), otherwise left as is
+};
+
+// Limits on rotated segments, 0 disables a limit. The oldest segments go first.
+struct RetentionPolicy {
+
+    // Public members
+
+    size_t m_max_files = 0;
+    uint64_t m_max_total_bytes = 0;
+    std::chrono::seconds m_max_age{0};
+
+    bool enabled() const noexcept {
+        return m_max_files != 0 || m_max_total_bytes != 0 || m_max_age.count() != 0;
+    }
+};
+
+// Compresses finished segments and applies the retention policy on its own thread,
+// so rotation only has to queue the segment index.
+class SegmentArchiver {
+public:
+
+    // Public types
+
+    struct Segment {
+        size_t m_index;
+        std::string m_path;
+        bool m_compressed;
+    };
+
+private:
+
+    // Private members
+
+    std::string m_base_filename;
+    Compression m_compression;
+    RetentionPolicy m_retention;
+
+    // Segments at or above m_active_index are still in use and never touched
+    std::atomic<size_t> m_active_index;
+
+    std::deque<size_t> m_pending;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop;
+    std::thread m_worker;
+
+    void run();
+    void compress(size_t p_index) noexcept;
+    // Drops the base.N.gz.tmp files left by a compression cut short by a crash
+    void removeStaleTemps() noexcept;
+    void applyRetention() noexcept;
+
+public:
+
+    // Constructor/Destructor
+
+    SegmentArchiver(const std::string& p_base_filename, Compression p_compression, const RetentionPolicy& p_retention);
+    // Finishes queued work before returning
+    ~SegmentArchiver();
+
+    SegmentArchiver(const SegmentArchiver&) = delete;
+    SegmentArchiver& operator=(const SegmentArchiver&) = delete;
+
+    // Methods
+
+    // Queues a finished segment, p_active_index is the segment now being written
+    void submit(size_t p_index, size_t p_active_index) noexcept;
+
+    // The compression actually applied, None when the requested one is not supported
+    Compression getCompression() const noexcept {
+        return m_compression;
+    }
+
+    // True if this build can honour p_compression
+    static bool isSupported(Compression p_compression) noexcept;
+
+    // Existing segments of p_base_filename (base.N and base.N.gz), sorted by index
+    static std::vector<Segment> listSegments(const std::string& p_base_filename);
+};
+
+} // namespace FZXLog::Sink
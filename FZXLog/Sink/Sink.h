@@ -1,9 +1,105 @@
 #pragma once
 
 #include "FZXLog/Fmt/Formatter.h"
+#include "FZXLog/Stats.h"
+
+#include <memory>
+#include <string_view>
+#include <vector>
 
 namespace FZXLog::Sink {
 
+// Lines rendered for one record, one per distinct formatter. A logger passes the same
+// cache to all of its sinks, so sinks sharing a formatter format the record only once.
+class RenderCache {
+private:
+
+    // Private types
+
+    struct Entry {
+        const FZXLog::Fmt::Formatter* m_formatter = nullptr;
+        std::string m_line;
+    };
+
+    // Private members
+
+    std::vector<Entry> m_entries; // Kept across records to reuse the string buffers
+    size_t m_used = 0;
+
+public:
+
+    // Methods
+
+    // Forgets the lines of the previous record
+    void clear() noexcept {
+        m_used = 0;
+    }
+
+    // The line p_formatter renders for the record, formatted on the first call.
+    // nullptr if memory runs out, the sink then formats on its own.
+    const std::string* render(
+        const FZXLog::Fmt::Formatter& p_formatter,
+        const SourceLocation& p_location,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const Fields& p_fields
+    ) noexcept {
+        for (size_t i = 0; i < m_used; ++i) {
+            if (m_entries[i].m_formatter == &p_formatter) return &m_entries[i].m_line;
+        }
+
+        try {
+            if (m_used == m_entries.size()) m_entries.emplace_back();
+        } catch (...) {
+            return nullptr;
+        }
+        Entry& entry = m_entries[m_used++];
+        entry.m_formatter = &p_formatter;
+        entry.m_line.clear();
+        p_formatter.format_to(entry.m_line, p_location, p_level, p_message, p_timestamp, p_thread_id, p_fields);
+        return &entry.m_line;
+    }
+
+    // The calling thread's cache for the duration of one fan-out. A nested fan-out on the
+    // same thread (a sink logging through another logger) gets a cache of its own.
+    class Scope {
+    private:
+        static inline thread_local bool t_busy = false;
+
+        static RenderCache& threadCache() noexcept {
+            static thread_local RenderCache t_cache;
+            return t_cache;
+        }
+
+        std::unique_ptr<RenderCache> m_nested;
+        RenderCache* m_cache;
+
+    public:
+        Scope() {
+            if (t_busy) {
+                m_nested = std::make_unique<RenderCache>();
+                m_cache = m_nested.get();
+            } else {
+                t_busy = true;
+                m_cache = &threadCache();
+                m_cache->clear();
+            }
+        }
+        ~Scope() {
+            if (!m_nested) t_busy = false;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        RenderCache& get() noexcept {
+            return *m_cache;
+        }
+    };
+};
+
 // Base Abstract Sink class
 class Sink {
 protected:
@@ -14,16 +110,67 @@ protected:
     Level m_level;
     Level m_flush_level;
 
+    // Statistics, only collected while enabled
+    enum StatIndex : size_t {
+        STAT_RECORDS = 0,
+        STAT_BYTES = 1,
+        STAT_ROTATIONS = 2,
+        STAT_WRITE_LATENCY = 3,
+        STAT_FLUSH_LATENCY = STAT_WRITE_LATENCY + LATENCY_BUCKETS,
+        STAT_COUNT = STAT_FLUSH_LATENCY + LATENCY_BUCKETS
+    };
+    std::atomic<bool> m_stats_enabled{false};
+    ShardedCounters<STAT_COUNT> m_stats;
+
+    // Set by sinks that implement writeFormatted()
+    bool m_accepts_formatted = false;
+
+    // For sink implementations: bytes that reached the file, rotations
+    void recordBytes(uint64_t p_bytes) noexcept {
+        if (m_stats_enabled.load(std::memory_order_relaxed)) m_stats.add(STAT_BYTES, p_bytes);
+    }
+    void recordRotation() noexcept {
+        if (m_stats_enabled.load(std::memory_order_relaxed)) m_stats.add(STAT_ROTATIONS);
+    }
+
     // Methods
 
     virtual void write(
         const SourceLocation& p_location,
         const Level& p_level,
         const std::string& p_message,
-        const std::chrono::system_clock::time_point& p_timestamp = std::chrono::system_clock::now(),
-        const std::thread::id& p_thread_id = std::this_thread::get_id()
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const Fields& p_fields
     ) noexcept = 0;
 
+    // Writes a line already rendered by m_formatter, without the trailing newline.
+    // Only called when m_accepts_formatted is set.
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
+    ) noexcept {
+        (void)p_level;
+        (void)p_line;
+        (void)p_timestamp;
+    }
+
+    // Runs p_write, recording the record and its latency when statistics are enabled
+    template<typename Write>
+    void timed(Write&& p_write) noexcept {
+        if (!m_stats_enabled.load(std::memory_order_relaxed)) {
+            p_write();
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        p_write();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        m_stats.add(STAT_RECORDS);
+        m_stats.add(STAT_WRITE_LATENCY + LatencyHistogram::bucketFor(static_cast<uint64_t>(ns)));
+    }
+
 public:
 
     // Constructor/Destructor
@@ -62,44 +209,130 @@ public:
         return m_formatter;
     }
 
-
-
     virtual void log(
         const SourceLocation& p_location,
         const FZXLog::Level& p_level,
         const std::string& p_message,
         const std::chrono::system_clock::time_point& p_timestamp = std::chrono::system_clock::now(),
-        const std::thread::id& p_thread_id = std::this_thread::get_id()
+        const std::thread::id& p_thread_id = std::this_thread::get_id(),
+        const Fields& p_fields = Fields()
     ) noexcept {
-        if (static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level) && p_level == Level::Off)
-            return;
-
-        write(p_location, p_level, p_message, p_timestamp, p_thread_id);
-
-        if (static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_flush_level))
-            flush();
+        if (append(p_location, p_level, p_message, p_timestamp, p_thread_id, p_fields))
+            timedFlush();
     }
 
     void log(
         const Level& p_level,
         const std::string& p_message,
         const std::chrono::system_clock::time_point& p_timestamp = std::chrono::system_clock::now(),
-        const std::thread::id& p_threadId = std::this_thread::get_id()
+        const std::thread::id& p_threadId = std::this_thread::get_id(),
+        const Fields& p_fields = Fields()
     ) noexcept {
-        if (static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level) && p_level == Level::Off)
-            return;
-        write(
-            SourceLocation(),
-            p_level,
-            p_message,
-            p_timestamp,
-            p_threadId
-        );
-        if (static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_flush_level))
+        log(SourceLocation(), p_level, p_message, p_timestamp, p_threadId, p_fields);
+    }
+
+    // Writes a record at or above the sink level without flushing. Returns true when the
+    // record reaches the flush level, loggers then let their FlushScheduler decide.
+    bool append(
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const Fields& p_fields = Fields()
+    ) noexcept {
+        if (static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level) || p_level == Level::Off)
+            return false;
+
+        timedWrite(p_location, p_level, p_message, p_timestamp, p_thread_id, p_fields);
+        return static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_flush_level);
+    }
+
+    // Same, taking the line from p_cache when this sink can write preformatted lines
+    bool append(
+        RenderCache& p_cache,
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const Fields& p_fields
+    ) noexcept {
+        if (!m_accepts_formatted || !m_formatter)
+            return append(p_location, p_level, p_message, p_timestamp, p_thread_id, p_fields);
+        if (static_cast<uint8_t>(p_level) < static_cast<uint8_t>(m_level) || p_level == Level::Off)
+            return false;
+
+        const std::string* line = p_cache.render(*m_formatter, p_location, p_level, p_message, p_timestamp, p_thread_id, p_fields);
+        if (line) {
+            timed([&] { writeFormatted(p_level, *line, p_timestamp); });
+        } else {
+            timedWrite(p_location, p_level, p_message, p_timestamp, p_thread_id, p_fields);
+        }
+        return static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_flush_level);
+    }
+
+    // write() with the latency recorded when statistics are enabled
+    void timedWrite(
+        const SourceLocation& p_location,
+        const FZXLog::Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_thread_id,
+        const Fields& p_fields = Fields()
+    ) noexcept {
+        timed([&] { write(p_location, p_level, p_message, p_timestamp, p_thread_id, p_fields); });
+    }
+
+    // flush() with the latency recorded when statistics are enabled
+    void timedFlush() noexcept {
+        if (!m_stats_enabled.load(std::memory_order_relaxed)) {
             flush();
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        flush();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        m_stats.add(STAT_FLUSH_LATENCY + LatencyHistogram::bucketFor(static_cast<uint64_t>(ns)));
+    }
+
+    // Statistics
+
+    void setStatsEnabled(bool p_enabled) noexcept {
+        m_stats_enabled.store(p_enabled, std::memory_order_relaxed);
+    }
+    bool getStatsEnabled() const noexcept {
+        return m_stats_enabled.load(std::memory_order_relaxed);
+    }
+    SinkStats getStats() const noexcept {
+        SinkStats stats;
+        stats.m_records = m_stats.sum(STAT_RECORDS);
+        stats.m_bytes = m_stats.sum(STAT_BYTES);
+        stats.m_rotations = m_stats.sum(STAT_ROTATIONS);
+        for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            stats.m_write_latency.m_buckets[i] = m_stats.sum(STAT_WRITE_LATENCY + i);
+            stats.m_flush_latency.m_buckets[i] = m_stats.sum(STAT_FLUSH_LATENCY + i);
+        }
+        return stats;
+    }
+    void resetStats() noexcept {
+        m_stats.reset();
     }
 
     virtual void flush() noexcept = 0;
+
+    // Crash path, called from a fatal signal handler (see Logger::CrashHandler) while other
+    // threads may be stopped anywhere: no locks, no allocation.
+
+    // Writes out what the sink still holds in memory
+    virtual void spillEmergency() noexcept {}
+    // Writes p_line and a newline straight to the sink's file, false if the sink cannot
+    virtual bool writeEmergency(const Level& p_level, std::string_view p_line) noexcept {
+        (void)p_level;
+        (void)p_line;
+        return false;
+    }
 };
 
 } // namespace FZXLog::Sink
@@ -0,0 +1,538 @@
+#include "UringFileSink.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace FZXLog::Sink {
+
+namespace {
+
+int uringSetup(unsigned p_entries, io_uring_params* p_params) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, p_entries, p_params));
+}
+
+int uringEnter(int p_fd, unsigned p_submit, unsigned p_wait, unsigned p_flags) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, p_fd, p_submit, p_wait, p_flags, nullptr, 0));
+}
+
+inline unsigned loadAcquire(const unsigned* p_value) noexcept {
+    return std::atomic_ref<const unsigned>(*p_value).load(std::memory_order_acquire);
+}
+
+inline void storeRelease(unsigned* p_value, unsigned p_new) noexcept {
+    std::atomic_ref<unsigned>(*p_value).store(p_new, std::memory_order_release);
+}
+
+} // namespace
+
+// Submission and completion rings of one io_uring instance, used by a single thread
+struct UringFileSink_st::Ring {
+
+    // Public members
+
+    int m_fd = -1;
+    void* m_sq_map = MAP_FAILED;
+    size_t m_sq_map_size = 0;
+    void* m_cq_map = MAP_FAILED;
+    size_t m_cq_map_size = 0;
+    io_uring_sqe* m_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t m_sqes_size = 0;
+
+    unsigned* m_sq_tail = nullptr;
+    unsigned* m_sq_mask = nullptr;
+    unsigned* m_sq_array = nullptr;
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned* m_cq_mask = nullptr;
+    io_uring_cqe* m_cqes = nullptr;
+
+    // Constructor/Destructor
+
+    Ring() = default;
+    ~Ring() {
+        if (m_sqes != MAP_FAILED) ::munmap(m_sqes, m_sqes_size);
+        if (m_cq_map != MAP_FAILED && m_cq_map != m_sq_map) ::munmap(m_cq_map, m_cq_map_size);
+        if (m_sq_map != MAP_FAILED) ::munmap(m_sq_map, m_sq_map_size);
+        if (m_fd >= 0) ::close(m_fd);
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    // Methods
+
+    bool init(unsigned p_entries) noexcept {
+        io_uring_params params{};
+        m_fd = uringSetup(p_entries, &params);
+        if (m_fd < 0) return false;
+
+        m_sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            m_sq_map_size = m_cq_map_size = std::max(m_sq_map_size, m_cq_map_size);
+        }
+
+        m_sq_map = ::mmap(nullptr, m_sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+        if (m_sq_map == MAP_FAILED) return false;
+        m_cq_map = single
+            ? m_sq_map
+            : ::mmap(nullptr, m_cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+        if (m_cq_map == MAP_FAILED) return false;
+
+        m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+        if (m_sqes == MAP_FAILED) return false;
+
+        char* sq = static_cast<char*>(m_sq_map);
+        m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        char* cq = static_cast<char*>(m_cq_map);
+        m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // Queues one writev and enters the kernel; the ring never holds more entries than buffers
+    bool submitWrite(int p_fd, const iovec* p_iov, uint64_t p_offset, uint64_t p_user_data) noexcept {
+        const unsigned tail = *m_sq_tail;
+        const unsigned index = tail & *m_sq_mask;
+        io_uring_sqe& sqe = m_sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITEV;
+        sqe.fd = p_fd;
+        sqe.addr = reinterpret_cast<uint64_t>(p_iov);
+        sqe.len = 1;
+        sqe.off = p_offset;
+        sqe.user_data = p_user_data;
+        m_sq_array[index] = index;
+        storeRelease(m_sq_tail, tail + 1);
+
+        for (;;) {
+            const int submitted = uringEnter(m_fd, 1, 0, 0);
+            if (submitted >= 0) return true;
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                // Take the entry back, the caller falls back to a synchronous write
+                storeRelease(m_sq_tail, tail);
+                return false;
+            }
+        }
+    }
+
+    // Calls p_visitor(user_data, result) for every completion
+    template<typename Visitor>
+    size_t drain(Visitor&& p_visitor) noexcept {
+        unsigned head = *m_cq_head;
+        const unsigned tail = loadAcquire(m_cq_tail);
+        size_t count = 0;
+        while (head != tail) {
+            const io_uring_cqe& cqe = m_cqes[head & *m_cq_mask];
+            p_visitor(cqe.user_data, static_cast<int64_t>(cqe.res));
+            ++head;
+            ++count;
+        }
+        storeRelease(m_cq_head, head);
+        return count;
+    }
+
+    void wait() noexcept {
+        while (uringEnter(m_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno == EINTR) {}
+    }
+};
+
+UringFileSink_st::UringFileSink_st(
+    const std::string& p_base_filename,
+    std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
+    const Level& p_level,
+    const Level& p_flush_level,
+    size_t p_max_file_size,
+    size_t p_buffer_size,
+    size_t p_buffer_count,
+    std::chrono::milliseconds p_flush_interval,
+    bool p_use_io_uring
+) noexcept :
+    Sink(std::move(p_formatter), p_level, p_flush_level),
+    m_base_filename(p_base_filename),
+    m_max_file_size(p_max_file_size),
+    m_next_file_index(0),
+    m_fd(-1),
+    m_file_offset(0),
+    m_buffer_size(p_buffer_size > 4096 ? p_buffer_size : 4096),
+    m_flush_interval(p_flush_interval),
+    m_last_submit(std::chrono::system_clock::now()),
+    m_current(0),
+    m_in_flight(0),
+    m_stop(false)
+{
+    try {
+        std::filesystem::path basePath(m_base_filename);
+        if (!basePath.parent_path().empty()) {
+            std::filesystem::create_directories(basePath.parent_path());
+        }
+
+        const size_t count = p_buffer_count > 2 ? p_buffer_count : 2;
+        m_buffers.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_buffers[i].m_data = std::make_unique<char[]>(m_buffer_size);
+            m_free.push_back(count - 1 - i);
+        }
+
+        if (p_use_io_uring) {
+            auto ring = std::make_unique<Ring>();
+            if (ring->init(static_cast<unsigned>(count))) m_ring = std::move(ring);
+        }
+        if (!m_ring) {
+            m_worker = std::thread(&UringFileSink_st::worker_loop, this);
+        }
+    } catch (...) {
+        m_buffers.clear();
+        m_free.clear();
+    }
+
+    m_current = m_buffers.size();
+    m_accepts_formatted = true;
+    open_next_file();
+}
+
+UringFileSink_st::~UringFileSink_st() {
+    flush();
+
+    if (m_worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_worker_mutex);
+            m_stop = true;
+        }
+        m_worker_cv.notify_one();
+        m_worker.join();
+    }
+
+    m_ring.reset();
+    close_retired();
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+bool UringFileSink_st::open_next_file() noexcept {
+    // Skip files that are already full (left by an earlier run)
+    for (;;) {
+        const std::string filename = m_base_filename + "." + std::to_string(m_next_file_index++);
+
+        const int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (m_max_file_size > 0 && static_cast<size_t>(st.st_size) >= m_max_file_size) {
+            ::close(fd);
+            continue;
+        }
+
+        m_fd = fd;
+        m_file_offset = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+}
+
+void UringFileSink_st::rotate_file() noexcept {
+    submit_current();
+    if (m_fd >= 0) m_retired.push_back(m_fd);
+    m_fd = -1;
+    open_next_file();
+    recordRotation();
+    close_retired();
+}
+
+void UringFileSink_st::submit_current() noexcept {
+    if (m_current == m_buffers.size()) return;
+
+    Buffer& buffer = m_buffers[m_current];
+    if (buffer.m_size == 0) return;
+
+    buffer.m_fd = m_fd;
+    buffer.m_offset = m_file_offset;
+    buffer.m_written = 0;
+    buffer.m_in_flight = true;
+    m_file_offset += buffer.m_size;
+    ++m_in_flight;
+
+    const size_t index = m_current;
+    m_current = m_buffers.size();
+    submit(index);
+}
+
+void UringFileSink_st::submit(size_t p_index) noexcept {
+    Buffer& buffer = m_buffers[p_index];
+    if (buffer.m_fd < 0) {
+        complete(p_index, -EBADF);
+        return;
+    }
+
+    buffer.m_iov.iov_base = buffer.m_data.get() + buffer.m_written;
+    buffer.m_iov.iov_len = buffer.m_size - buffer.m_written;
+
+    if (m_ring) {
+        if (m_ring->submitWrite(buffer.m_fd, &buffer.m_iov, buffer.m_offset + buffer.m_written, p_index)) return;
+
+        // The ring refused the entry, write synchronously rather than lose the data
+        const ssize_t written = ::pwrite(buffer.m_fd, buffer.m_iov.iov_base, buffer.m_iov.iov_len,
+            static_cast<off_t>(buffer.m_offset + buffer.m_written));
+        complete(p_index, written < 0 ? -errno : written);
+        return;
+    }
+
+    try {
+        {
+            std::lock_guard<std::mutex> lock(m_worker_mutex);
+            m_pending.push_back(p_index);
+        }
+        m_worker_cv.notify_one();
+    } catch (...) {
+        complete(p_index, -ENOMEM);
+    }
+}
+
+void UringFileSink_st::complete(size_t p_index, int64_t p_result) noexcept {
+    Buffer& buffer = m_buffers[p_index];
+
+    if (p_result == -EINTR || p_result == -EAGAIN) {
+        submit(p_index);
+        return;
+    }
+    if (p_result > 0) {
+        buffer.m_written += static_cast<size_t>(p_result);
+        recordBytes(static_cast<uint64_t>(p_result));
+        if (buffer.m_written < buffer.m_size) {
+            // Short write, queue the rest
+            submit(p_index);
+            return;
+        }
+    } else {
+        m_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    buffer.m_in_flight = false;
+    buffer.m_size = 0;
+    --m_in_flight;
+    m_free.push_back(p_index);
+}
+
+void UringFileSink_st::reap(bool p_wait) noexcept {
+    if (m_in_flight == 0) return;
+
+    if (m_ring) {
+        const auto visit = [this](uint64_t p_index, int64_t p_result) { complete(static_cast<size_t>(p_index), p_result); };
+        if (m_ring->drain(visit) == 0 && p_wait) {
+            m_ring->wait();
+            m_ring->drain(visit);
+        }
+    } else {
+        std::vector<std::pair<size_t, int64_t>> completed;
+        {
+            std::unique_lock<std::mutex> lock(m_worker_mutex);
+            if (p_wait) {
+                m_completed_cv.wait(lock, [this] { return !m_completed.empty(); });
+            }
+            completed.swap(m_completed);
+        }
+        for (const auto& [index, result] : completed) {
+            complete(index, result);
+        }
+    }
+
+    close_retired();
+}
+
+void UringFileSink_st::close_retired() noexcept {
+    for (size_t i = 0; i < m_retired.size();) {
+        bool busy = false;
+        for (const Buffer& buffer : m_buffers) {
+            busy |= buffer.m_in_flight && buffer.m_fd == m_retired[i];
+        }
+        if (busy) {
+            ++i;
+            continue;
+        }
+        ::close(m_retired[i]);
+        m_retired[i] = m_retired.back();
+        m_retired.pop_back();
+    }
+}
+
+bool UringFileSink_st::acquire() noexcept {
+    if (m_current != m_buffers.size()) return true;
+    if (m_buffers.empty()) return false;
+
+    if (m_free.empty()) reap(false);
+    while (m_free.empty()) reap(true);
+
+    m_current = m_free.back();
+    m_free.pop_back();
+    m_buffers[m_current].m_size = 0;
+    return true;
+}
+
+void UringFileSink_st::worker_loop() noexcept {
+    for (;;) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(m_worker_mutex);
+            m_worker_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+            if (m_pending.empty()) return;
+            index = m_pending.front();
+            m_pending.pop_front();
+        }
+
+        // Buffer fields are only touched by the logging thread once the index comes back
+        const Buffer& buffer = m_buffers[index];
+        const char* data = buffer.m_data.get() + buffer.m_written;
+        const size_t size = buffer.m_size - buffer.m_written;
+        const off_t offset = static_cast<off_t>(buffer.m_offset + buffer.m_written);
+        size_t done = 0;
+        int64_t result = 0;
+        while (done < size) {
+            const ssize_t written = ::pwrite(buffer.m_fd, data + done, size - done, offset + static_cast<off_t>(done));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                result = -errno;
+                break;
+            }
+            done += static_cast<size_t>(written);
+        }
+        if (done > 0) result = static_cast<int64_t>(done);
+
+        try {
+            std::lock_guard<std::mutex> lock(m_worker_mutex);
+            m_completed.emplace_back(index, result);
+        } catch (...) {}
+        m_completed_cv.notify_one();
+    }
+}
+
+void UringFileSink_st::write(
+    const SourceLocation& p_loc,
+    const Level& p_level,
+    const std::string& p_message,
+    const std::chrono::system_clock::time_point& p_timestamp,
+    const std::thread::id& p_threadId,
+    const Fields& p_fields
+) noexcept {
+    try {
+        m_line.clear();
+        if (m_formatter) {
+            m_formatter->format_to(m_line, p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+        } else {
+            m_line.append(p_message);
+        }
+        m_line.push_back('\n');
+    } catch (...) {
+        return;
+    }
+
+    enqueue(p_timestamp);
+}
+
+void UringFileSink_st::writeFormatted(
+    const Level&,
+    std::string_view p_line,
+    const std::chrono::system_clock::time_point& p_timestamp
+) noexcept {
+    try {
+        m_line.assign(p_line);
+        m_line.push_back('\n');
+    } catch (...) {
+        return;
+    }
+    enqueue(p_timestamp);
+}
+
+void UringFileSink_st::enqueue(const std::chrono::system_clock::time_point& p_timestamp) noexcept {
+    // Pick up finished writes without waiting, so buffers return to the pool early
+    reap(false);
+
+    const size_t buffered = m_current != m_buffers.size() ? m_buffers[m_current].m_size : 0;
+    if (m_max_file_size > 0 && m_file_offset + buffered > 0 && m_file_offset + buffered + m_line.size() > m_max_file_size) {
+        rotate_file();
+    }
+
+    // Lines longer than a buffer continue in the next one
+    const char* data = m_line.data();
+    size_t remaining = m_line.size();
+    while (remaining > 0) {
+        if (!acquire()) return;
+        Buffer& buffer = m_buffers[m_current];
+        const size_t chunk = std::min(remaining, m_buffer_size - buffer.m_size);
+        std::memcpy(buffer.m_data.get() + buffer.m_size, data, chunk);
+        buffer.m_size += chunk;
+        data += chunk;
+        remaining -= chunk;
+        if (buffer.m_size == m_buffer_size) {
+            submit_current();
+            m_last_submit = p_timestamp;
+        }
+    }
+
+    if (p_timestamp - m_last_submit >= m_flush_interval) {
+        submit_current();
+        m_last_submit = p_timestamp;
+    }
+}
+
+void UringFileSink_st::flush() noexcept {
+    submit_current();
+    while (m_in_flight > 0) reap(true);
+    close_retired();
+}
+
+void UringFileSink_st::spillEmergency() noexcept {
+    if (m_current == m_buffers.size() || m_fd < 0) return;
+
+    Buffer& buffer = m_buffers[m_current];
+    size_t done = 0;
+    while (done < buffer.m_size) {
+        const ssize_t written = ::pwrite(m_fd, buffer.m_data.get() + done, buffer.m_size - done, static_cast<off_t>(m_file_offset + done));
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) break;
+        done += static_cast<size_t>(written);
+    }
+    m_file_offset += buffer.m_size;
+    buffer.m_size = 0;
+}
+
+bool UringFileSink_st::writeEmergency(const Level&, std::string_view p_line) noexcept {
+    if (m_fd < 0) return false;
+
+    char newline = '\n';
+    iovec iov[2] = {{const_cast<char*>(p_line.data()), p_line.size()}, {&newline, 1}};
+    const size_t size = p_line.size() + 1;
+    ssize_t written;
+    do {
+        written = ::pwritev(m_fd, iov, 2, static_cast<off_t>(m_file_offset));
+    } while (written < 0 && errno == EINTR);
+    if (written < 0) return false;
+
+    m_file_offset += static_cast<uint64_t>(written);
+    return static_cast<size_t>(written) == size;
+}
+
+} // namespace FZXLog::Sink
+
+#endif // __linux__
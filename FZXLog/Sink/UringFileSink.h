@@ -0,0 +1,211 @@
+#pragma once
+
+#include "Sink.h"
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace FZXLog::Sink {
+
+// Linux file sink that hands filled buffers to the kernel without waiting for the write.
+// Records are formatted into one of p_buffer_count buffers; a full buffer is submitted
+// through io_uring (raw syscalls, no liburing) and the next free buffer takes over.
+// Buffers are reused as their writes complete. Where io_uring is unavailable (old
+// kernels, seccomp filters) a worker thread writes the buffers with pwrite instead.
+// The logging thread only waits when every buffer is still in flight, and in flush(),
+// which returns once everything submitted is written. Files rotate as base.0, base.1, ...
+class UringFileSink_st : public Sink {
+private:
+
+    // Private types
+
+    struct Buffer {
+        std::unique_ptr<char[]> m_data;
+        size_t m_size = 0;
+        size_t m_written = 0;
+        int m_fd = -1;
+        uint64_t m_offset = 0;
+        bool m_in_flight = false;
+        iovec m_iov{};
+    };
+
+    // io_uring mappings, defined in the .cpp
+    struct Ring;
+
+    // Private members
+
+    std::string m_base_filename;
+    size_t m_max_file_size;
+    size_t m_next_file_index;
+    int m_fd;
+    uint64_t m_file_offset;     // Bytes of the current file already submitted
+    std::vector<int> m_retired; // Rotated files, closed once their writes complete
+
+    size_t m_buffer_size;
+    std::chrono::milliseconds m_flush_interval;
+    std::chrono::system_clock::time_point m_last_submit;
+    std::vector<Buffer> m_buffers;
+    std::vector<size_t> m_free;
+    size_t m_current;           // Buffer being filled, m_buffers.size() if none
+    size_t m_in_flight;
+    std::string m_line;
+    std::atomic<uint64_t> m_errors{0};
+
+    std::unique_ptr<Ring> m_ring;
+
+    // pwrite fallback: the worker takes indices from m_pending and returns them in m_completed
+    std::thread m_worker;
+    std::mutex m_worker_mutex;
+    std::condition_variable m_worker_cv;
+    std::condition_variable m_completed_cv;
+    std::deque<size_t> m_pending;
+    std::vector<std::pair<size_t, int64_t>> m_completed;
+    bool m_stop;
+
+    bool open_next_file() noexcept;
+    void rotate_file() noexcept;
+
+    // Hands the current buffer to the kernel or the worker
+    void submit_current() noexcept;
+    void submit(size_t p_index) noexcept;
+    // Processes finished writes; with p_wait, blocks until at least one finishes
+    void reap(bool p_wait) noexcept;
+    void complete(size_t p_index, int64_t p_result) noexcept;
+    void close_retired() noexcept;
+    // Makes m_current a buffer with free space, waiting for a completion if needed
+    bool acquire() noexcept;
+    // Copies m_line into the buffers
+    void enqueue(const std::chrono::system_clock::time_point& p_timestamp) noexcept;
+
+    void worker_loop() noexcept;
+
+protected:
+
+    // Methods
+
+    virtual void write(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override;
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
+    ) noexcept override;
+
+public:
+
+    // Constructor/Destructor
+
+    UringFileSink_st(
+        const std::string& p_base_filename,
+        std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
+        const Level& p_level = Level::Trace,
+        const Level& p_flush_level = Level::Error,
+        size_t p_max_file_size = 10 * 1024 * 1024, // 10 MB
+        size_t p_buffer_size = 256 * 1024, // 256 KiB
+        size_t p_buffer_count = 4,
+        std::chrono::milliseconds p_flush_interval = std::chrono::milliseconds(1000),
+        bool p_use_io_uring = true
+    ) noexcept;
+    virtual ~UringFileSink_st() override;
+
+    UringFileSink_st(const UringFileSink_st&) = delete;
+    UringFileSink_st& operator=(const UringFileSink_st&) = delete;
+
+    // Methods
+
+    // Submits the current buffer and waits until every submitted write is done
+    virtual void flush() noexcept override;
+
+    // Writes the buffer being filled with pwrite; buffers already submitted are left to
+    // the kernel or the worker
+    virtual void spillEmergency() noexcept override;
+    virtual bool writeEmergency(const Level& p_level, std::string_view p_line) noexcept override;
+
+    // False when writes go through the pwrite worker
+    bool usesIoUring() const noexcept {
+        return m_ring != nullptr;
+    }
+    // Writes that failed, their data is lost
+    uint64_t getErrorCount() const noexcept {
+        return m_errors.load(std::memory_order_relaxed);
+    }
+};
+
+class UringFileSink_mt : public UringFileSink_st {
+private:
+
+    // Mutex for thread safety
+    std::mutex m_mutex;
+
+protected:
+
+    // Methods
+
+    virtual void write(
+        const SourceLocation& p_loc,
+        const Level& p_level,
+        const std::string& p_message,
+        const std::chrono::system_clock::time_point& p_timestamp,
+        const std::thread::id& p_threadId,
+        const Fields& p_fields
+    ) noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        UringFileSink_st::write(p_loc, p_level, p_message, p_timestamp, p_threadId, p_fields);
+    }
+    virtual void writeFormatted(
+        const Level& p_level,
+        std::string_view p_line,
+        const std::chrono::system_clock::time_point& p_timestamp
+    ) noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        UringFileSink_st::writeFormatted(p_level, p_line, p_timestamp);
+    }
+
+public:
+
+    // Constructor/Destructor
+
+    UringFileSink_mt(
+        const std::string& p_base_filename,
+        std::shared_ptr<FZXLog::Fmt::Formatter> p_formatter,
+        const Level& p_level = Level::Trace,
+        const Level& p_flush_level = Level::Error,
+        size_t p_max_file_size = 10 * 1024 * 1024, // 10 MB
+        size_t p_buffer_size = 256 * 1024, // 256 KiB
+        size_t p_buffer_count = 4,
+        std::chrono::milliseconds p_flush_interval = std::chrono::milliseconds(1000),
+        bool p_use_io_uring = true
+    ) noexcept :
+        UringFileSink_st(p_base_filename, std::move(p_formatter), p_level, p_flush_level,
+            p_max_file_size, p_buffer_size, p_buffer_count, p_flush_interval, p_use_io_uring)
+    {}
+    virtual ~UringFileSink_mt() override = default;
+
+    // Methods
+
+    virtual void flush() noexcept override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        UringFileSink_st::flush();
+    }
+};
+
+} // namespace FZXLog::Sink
+
+#endif // __linux__
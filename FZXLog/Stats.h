@@ -0,0 +1,132 @@
+#pragma once
+
+#include "FZXLog/Utils.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+
+namespace FZXLog {
+
+constexpr size_t STATS_SHARDS = 16;
+constexpr size_t LEVEL_COUNT = 6; // Trace..Fatal
+constexpr size_t LATENCY_BUCKETS = 32;
+
+// Shard used by the calling thread, threads are spread round robin
+inline size_t statsShard() noexcept {
+    static constinit std::atomic<size_t> s_next{0};
+    thread_local size_t t_shard = s_next.fetch_add(1, std::memory_order_relaxed) % STATS_SHARDS;
+    return t_shard;
+}
+
+// Fixed set of relaxed counters split into cache-line aligned per-thread shards.
+// Adding touches only the caller's shard, reading sums all of them.
+template<size_t Count>
+class ShardedCounters {
+private:
+
+    // Private members
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> m_values[Count] = {};
+    };
+
+    Shard m_shards[STATS_SHARDS];
+
+public:
+
+    // Methods
+
+    void add(size_t p_index, uint64_t p_value = 1) noexcept {
+        m_shards[statsShard()].m_values[p_index].fetch_add(p_value, std::memory_order_relaxed);
+    }
+
+    uint64_t sum(size_t p_index) const noexcept {
+        uint64_t total = 0;
+        for (const Shard& shard : m_shards) {
+            total += shard.m_values[p_index].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void reset() noexcept {
+        for (Shard& shard : m_shards) {
+            for (auto& value : shard.m_values) value.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Latency histogram with power-of-two buckets: bucket i holds durations in [2^(i-1), 2^i) ns,
+// the last bucket everything above
+struct LatencyHistogram {
+
+    // Public members
+
+    std::array<uint64_t, LATENCY_BUCKETS> m_buckets{};
+
+    // Methods
+
+    static constexpr size_t bucketFor(uint64_t p_nanoseconds) noexcept {
+        const size_t bucket = static_cast<size_t>(std::bit_width(p_nanoseconds));
+        return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+    }
+
+    // Largest duration that falls in p_bucket
+    static constexpr uint64_t bucketUpperBound(size_t p_bucket) noexcept {
+        return p_bucket == 0 ? 0 : (uint64_t(1) << p_bucket) - 1;
+    }
+
+    uint64_t count() const noexcept {
+        uint64_t total = 0;
+        for (uint64_t value : m_buckets) total += value;
+        return total;
+    }
+
+    // Upper bound (ns) of the bucket holding the p_rank quantile, p_rank in [0, 1]
+    uint64_t percentile(double p_rank) const noexcept {
+        const uint64_t total = count();
+        if (total == 0) return 0;
+        const uint64_t wanted = static_cast<uint64_t>(p_rank * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += m_buckets[i];
+            if (seen >= wanted) return bucketUpperBound(i);
+        }
+        return bucketUpperBound(LATENCY_BUCKETS - 1);
+    }
+};
+
+struct LoggerStats {
+
+    // Public members
+
+    std::array<uint64_t, LEVEL_COUNT> m_accepted{}; // Passed the level and filters, per level
+    std::array<uint64_t, LEVEL_COUNT> m_filtered{}; // Stopped by a level or filter, or backtrace only
+    uint64_t m_dropped = 0;                         // Lost to queue overflow (async loggers)
+    size_t m_queue_depth = 0;
+    size_t m_queue_high_water = 0;
+    uint64_t m_flushes = 0;                         // Sink flushes run by the flush scheduler
+    uint64_t m_flush_requests = 0;                  // Flushes asked for, coalesced ones included
+
+    uint64_t accepted(Level p_level) const noexcept {
+        return static_cast<size_t>(p_level) < LEVEL_COUNT ? m_accepted[static_cast<size_t>(p_level)] : 0;
+    }
+    uint64_t filtered(Level p_level) const noexcept {
+        return static_cast<size_t>(p_level) < LEVEL_COUNT ? m_filtered[static_cast<size_t>(p_level)] : 0;
+    }
+};
+
+struct SinkStats {
+
+    // Public members
+
+    uint64_t m_records = 0;
+    uint64_t m_bytes = 0;       // Bytes handed to the OS or the mapping
+    uint64_t m_rotations = 0;
+    LatencyHistogram m_write_latency;
+    LatencyHistogram m_flush_latency;
+};
+
+} // namespace FZXLog
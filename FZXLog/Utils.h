@@ -1,8 +1,14 @@
 #pragma once
 
+#include "FZXLog/Fields.h"
+
+#include <atomic>
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <source_location>
 #include <thread>
+#include <utility>
 #include <stdint.h>
 
 namespace FZXLog {
@@ -30,33 +36,163 @@ static constexpr const char* FZXLogLevelToString(Level p_level) noexcept {
     }
 }
 
-struct SourceLocation {
+// Parses a level name, ignoring case ("warn" is accepted for Warning). False if unknown.
+constexpr bool FZXLogLevelFromString(std::string_view p_text, Level& p_level) noexcept {
+    constexpr std::pair<std::string_view, Level> names[] = {
+        {"trace", Level::Trace}, {"debug", Level::Debug}, {"info", Level::Info},
+        {"warning", Level::Warning}, {"warn", Level::Warning}, {"error", Level::Error},
+        {"fatal", Level::Fatal}, {"off", Level::Off}
+    };
+    for (const auto& [name, level] : names) {
+        if (name.size() != p_text.size()) continue;
+        bool equal = true;
+        for (size_t i = 0; i < name.size() && equal; ++i) {
+            const char c = p_text[i];
+            equal = (c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c) == name[i];
+        }
+        if (equal) {
+            p_level = level;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Part of p_path after the last separator, usable in constant expressions
+constexpr const char* fileBasename(const char* p_path) noexcept {
+    const char* base = p_path;
+    for (const char* it = p_path; *it; ++it) {
+        if (*it == '/' || *it == '\\') base = it + 1;
+    }
+    return base;
+}
+
+// Static metadata of one logging call site.
+// The logging macros keep one constant-initialized instance per call site, records only
+// carry a pointer to it. Sites register themselves in CallSiteRegistry on first use.
+struct CallSite {
 
     // Public members
 
     const char* m_file;
     uint32_t m_line;
     const char* m_func;
+    Level m_level; // Off when the level is chosen at runtime
+    std::string_view m_format;
+
+    std::atomic<bool> m_enabled;
+    std::atomic<uint64_t> m_hits;
+    std::atomic<bool> m_registered;
+    CallSite* m_next; // Registry list, set once when registered
 
     // Constructor/Destructor
 
-    inline SourceLocation(
+    constexpr CallSite(
         const char* p_file = "",
         uint32_t p_line = -1,
-        const char* p_func = ""
+        const char* p_func = "",
+        Level p_level = Level::Off,
+        std::string_view p_format = std::string_view()
     ) noexcept :
         m_file(p_file),
         m_line(p_line),
-        m_func(p_func)
+        m_func(p_func),
+        m_level(p_level),
+        m_format(p_format),
+        m_enabled(true),
+        m_hits(0),
+        m_registered(false),
+        m_next(nullptr)
     {}
+
+    CallSite(const CallSite&) = delete;
+    CallSite& operator=(const CallSite&) = delete;
+
+    // Methods
+
+    // Counts a hit, returns false if the site was switched off
+    bool hit() noexcept {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const noexcept {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+    void setEnabled(bool p_enabled) noexcept {
+        m_enabled.store(p_enabled, std::memory_order_relaxed);
+    }
+    uint64_t getHits() const noexcept {
+        return m_hits.load(std::memory_order_relaxed);
+    }
+
+    // A site for a location built by hand, one per distinct (p_file, p_line, p_func) kept
+    // for the life of the process. The strings are not copied, like those of any site.
+    static const CallSite& intern(const char* p_file, uint32_t p_line, const char* p_func) noexcept;
+};
+
+// Location of records that were not logged through a call site
+inline constinit CallSite s_unknown_call_site{};
+
+// A string copied into a template argument, so it can name a constant-initialized site
+template<size_t N>
+struct SiteText {
+    char m_text[N] = {};
+
+    consteval SiteText(const char* p_text) noexcept {
+        for (size_t i = 0; i < N; ++i) m_text[i] = p_text[i];
+    }
+};
+
+consteval size_t siteTextSize(const char* p_text) noexcept {
+    size_t size = 0;
+    while (p_text[size]) ++size;
+    return size + 1;
+}
+
+// The site of FZXLOG_SOURCE_LOCATION, one per file, line and function
+template<SiteText File, uint32_t Line, SiteText Func>
+inline constinit CallSite s_source_call_site{File.m_text, Line, Func.m_text, Level::Off};
+
+// Handle to a record's call site, a single pointer
+struct SourceLocation {
+
+    // Public members
+
+    const CallSite* m_site;
+
+    // Constructor/Destructor
+
+    constexpr SourceLocation() noexcept :
+        m_site(&s_unknown_call_site)
+    {}
+    constexpr SourceLocation(const CallSite& p_site) noexcept :
+        m_site(&p_site)
+    {}
+    // A location built by hand, backed by an interned CallSite (see CallSite::intern).
+    // Slower than the macros, which own their site.
+    SourceLocation(const char* p_file, uint32_t p_line = -1, const char* p_func = "") noexcept :
+        m_site(&CallSite::intern(p_file, p_line, p_func))
+    {}
+    constexpr SourceLocation(const SourceLocation&) noexcept = default;
     ~SourceLocation() = default;
 
     // Operators
     
     inline void operator=(const SourceLocation& p_other) noexcept {
-        m_file = p_other.m_file;
-        m_line = p_other.m_line;
-        m_func = p_other.m_func;
+        m_site = p_other.m_site;
+    }
+
+    // Methods
+
+    constexpr const char* file() const noexcept {
+        return m_site->m_file;
+    }
+    constexpr uint32_t line() const noexcept {
+        return m_site->m_line;
+    }
+    constexpr const char* function() const noexcept {
+        return m_site->m_func;
     }
 };
 
@@ -69,34 +205,45 @@ struct LogRecord {
     std::string m_message;
     std::chrono::system_clock::time_point m_timestamp;
     std::thread::id m_threadId;
+    Fields m_fields;
 
 
     // Constructor/Destructor
 
+    inline LogRecord() noexcept :
+        m_level(Level::Off)
+    {}
+
     inline LogRecord(
         const SourceLocation& p_location,
         const Level& p_level,
         const std::string& p_message,
         const std::chrono::system_clock::time_point& p_timestamp,
-        const std::thread::id& p_threadId
+        const std::thread::id& p_threadId,
+        const Fields& p_fields = Fields()
     ) noexcept :
         m_location(p_location),
         m_level(p_level),
         m_message(p_message),
         m_timestamp(p_timestamp),
-        m_threadId(p_threadId)
+        m_threadId(p_threadId),
+        m_fields(p_fields)
     {}
 
+    LogRecord(const LogRecord&) = default;
+    LogRecord(LogRecord&&) noexcept = default;
     ~LogRecord() = default;
 
     // Operators
 
+    LogRecord& operator=(LogRecord&&) noexcept = default;
     inline void operator=(const LogRecord& other) noexcept {
         m_location = other.m_location;
         m_level = other.m_level;
         m_message = other.m_message;
         m_timestamp = other.m_timestamp;
         m_threadId = other.m_threadId;
+        m_fields = other.m_fields;
     }
 };
 
@@ -110,5 +257,14 @@ struct LogRecord {
 #define FZXLOG_LEVEL_FATAL      FZXLog::Level::Fatal
 #define FZXLOG_LEVEL_OFF        FZXLog::Level::Off
 
+#define FZXLOG_SITE_TEXT_(p_text) FZXLog::SiteText<FZXLog::siteTextSize(p_text)>(p_text)
+
+// Location of the enclosing code, backed by a constant-initialized CallSite built like the
+// ones of the logging macros. std::source_location is read where the macro expands, so the
+// function is the caller's.
 #define FZXLOG_SOURCE_LOCATION \
-    FZXLog::SourceLocation(__FILE__, __LINE__, __FUNCTION__)
+    FZXLog::SourceLocation(FZXLog::s_source_call_site< \
+        FZXLOG_SITE_TEXT_(FZXLog::fileBasename(std::source_location::current().file_name())), \
+        std::source_location::current().line(), \
+        FZXLOG_SITE_TEXT_(std::source_location::current().function_name()) \
+    >)
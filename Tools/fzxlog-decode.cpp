@@ -0,0 +1,91 @@
+// fzxlog-decode: renders binary logs written by BinaryFileSink as text.
+//
+//   fzxlog-decode [-p pattern | -j] [-u] file...
+//
+//   -p pattern   PatternFormatter pattern (default FZXLOG_FMT_PATTERN_FULL)
+//   -j           one JSON object per record (JsonFormatter), fields included
+//   -u           print times in UTC instead of local time
+
+#include "FZXLog/Fmt/JsonFormatter.h"
+#include "FZXLog/Fmt/PatternFormatter.h"
+#include "FZXLog/Sink/BinaryFormat.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr, "usage: fzxlog-decode [-p pattern | -j] [-u] file...\n");
+}
+
+bool readFile(const char* p_path, std::string& p_out) {
+    std::ifstream in(p_path, std::ios::binary);
+    if (!in) return false;
+    p_out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string pattern = FZXLOG_FMT_PATTERN_FULL;
+    FZXLog::Fmt::Timezone timezone = FZXLog::Fmt::Timezone::Local;
+    bool json = false;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            pattern = argv[++i];
+        } else if (std::strcmp(argv[i], "-j") == 0) {
+            json = true;
+        } else if (std::strcmp(argv[i], "-u") == 0) {
+            timezone = FZXLog::Fmt::Timezone::UTC;
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        usage();
+        return 2;
+    }
+
+    const FZXLog::Fmt::PatternFormatter formatter(pattern, timezone);
+    const FZXLog::Fmt::JsonFormatter jsonFormatter(timezone);
+    std::string data;
+    std::string line;
+    int status = 0;
+
+    for (const char* path : files) {
+        if (!readFile(path, data)) {
+            std::fprintf(stderr, "fzxlog-decode: cannot read %s\n", path);
+            status = 1;
+            continue;
+        }
+
+        FZXLog::Sink::Binary::Reader reader(data);
+        FZXLog::Sink::Binary::Reader::Record record;
+        while (reader.next(record)) {
+            line.clear();
+            if (json) {
+                jsonFormatter.format_to(line, record.m_location, record.m_level, record.m_message, record.m_timestamp, record.m_thread, record.m_fields);
+            } else {
+                formatter.format_to(line, record.m_location, record.m_level, record.m_message, record.m_timestamp, record.m_thread, record.m_fields);
+            }
+            line.push_back('\n');
+            std::fwrite(line.data(), 1, line.size(), stdout);
+        }
+
+        if (reader.skippedBytes() > 0) {
+            std::fprintf(stderr, "fzxlog-decode: %s: skipped %zu damaged bytes\n", path, reader.skippedBytes());
+        }
+    }
+    return status;
+}